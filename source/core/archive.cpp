@@ -0,0 +1,177 @@
+#include "archive.h"
+#include <cstring>
+#include <limits>
+
+namespace tt
+{
+	namespace
+	{
+		std::uint32_t checksum(void const* data, std::size_t size)
+		{
+			return murmur_hash3(static_cast<char const*>(data), static_cast<std::uint32_t>(size));
+		}
+
+		std::uint64_t align_up(std::uint64_t offset)
+		{
+			return (offset + archive_alignment - 1) & ~std::uint64_t{ archive_alignment - 1 };
+		}
+	}
+
+	c_archive_writer::c_archive_writer()
+		: m_offset(0)
+		, m_good(false)
+	{
+	}
+
+	c_archive_writer::~c_archive_writer()
+	{
+		if (m_out.is_open())
+		{
+			finish();
+		}
+	}
+
+	bool c_archive_writer::open(char const* path)
+	{
+		if (m_out.is_open() && !finish())
+		{
+			return false;
+		}
+		m_out.open(path, std::ios::binary | std::ios::trunc);
+		// The header is rewritten by finish() once the table offset is known.
+		s_archive_header const header = {};
+		m_out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		m_offset = sizeof(header);
+		m_good = m_out.good();
+		return m_good;
+	}
+
+	bool c_archive_writer::write(c_hash name, c_hash type, std::uint32_t stride, void const* data, std::size_t count)
+	{
+		std::uint64_t const size = static_cast<std::uint64_t>(stride) * count;
+		if (!m_out.is_open() || size > std::numeric_limits<std::uint32_t>::max())
+		{
+			m_good = false;
+			return false;
+		}
+
+		static char const padding[archive_alignment] = {};
+		std::uint64_t const offset = align_up(m_offset);
+		m_out.write(padding, static_cast<std::streamsize>(offset - m_offset));
+		m_out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+		m_offset = offset + size;
+
+		m_sections.push_back({ name.m_hash, type.m_hash, stride, checksum(data, static_cast<std::size_t>(size)), offset, count });
+		m_good = m_good && m_out.good();
+		return m_good;
+	}
+
+	bool c_archive_writer::finish()
+	{
+		if (!m_out.is_open())
+		{
+			return false;
+		}
+
+		static char const padding[archive_alignment] = {};
+		std::uint64_t const table_offset = align_up(m_offset);
+		std::size_t const table_size = m_sections.size() * sizeof(s_archive_section);
+		m_out.write(padding, static_cast<std::streamsize>(table_offset - m_offset));
+		m_out.write(reinterpret_cast<char const*>(m_sections.data()), static_cast<std::streamsize>(table_size));
+
+		s_archive_header const header = {
+			archive_magic,
+			archive_version,
+			table_offset,
+			static_cast<std::uint32_t>(m_sections.size()),
+			checksum(m_sections.data(), table_size),
+		};
+		m_out.seekp(0);
+		m_out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		m_out.close();
+		m_good = m_good && !m_out.fail();
+		m_sections.clear();
+		return m_good;
+	}
+
+	bool c_archive_reader::open(char const* path, bool verify)
+	{
+		close();
+		c_mapped_file file;
+		if (!file.open(path) || !open(file.data(), verify))
+		{
+			return false;
+		}
+		m_file = std::move(file);
+		return true;
+	}
+
+	bool c_archive_reader::open(std::span<std::byte const> data, bool verify)
+	{
+		close();
+		s_archive_header header;
+		if (data.size() < sizeof(header) || reinterpret_cast<std::uintptr_t>(data.data()) % archive_alignment != 0)
+		{
+			return false;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+		if (header.magic != archive_magic || header.version != archive_version || header.table_offset % archive_alignment != 0
+			|| header.table_offset > data.size() || (data.size() - header.table_offset) / sizeof(s_archive_section) < header.section_count)
+		{
+			return false;
+		}
+
+		std::span<s_archive_section const> const sections(reinterpret_cast<s_archive_section const*>(data.data() + header.table_offset), header.section_count);
+		if (checksum(sections.data(), sections.size_bytes()) != header.table_checksum)
+		{
+			return false;
+		}
+		for (s_archive_section const& section : sections)
+		{
+			if (section.stride == 0 || section.offset % archive_alignment != 0 || section.offset > header.table_offset
+				|| (header.table_offset - section.offset) / section.stride < section.count)
+			{
+				return false;
+			}
+			if (verify && checksum(data.data() + section.offset, static_cast<std::size_t>(section.count * section.stride)) != section.checksum)
+			{
+				return false;
+			}
+		}
+
+		m_data = data;
+		m_sections = sections;
+		return true;
+	}
+
+	void c_archive_reader::close()
+	{
+		m_file.close();
+		m_data = {};
+		m_sections = {};
+	}
+
+	bool c_archive_reader::contains(c_hash name) const
+	{
+		for (s_archive_section const& section : m_sections)
+		{
+			if (section.name == name.m_hash)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	s_archive_section const* c_archive_reader::find(c_hash name, c_hash type, std::uint32_t stride) const
+	{
+		for (s_archive_section const& section : m_sections)
+		{
+			if (section.name == name.m_hash)
+			{
+				return section.type == type.m_hash && section.stride == stride ? &section : nullptr;
+			}
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "core/ds.h"
+#include "core/hash.h"
+#include "core/mapped_file.h"
+#include "core/math.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace tt
+{
+	// Records are stored in their in-memory layout, so an archive can be mapped and read in place.
+	static_assert(std::endian::native == std::endian::little, "Archives are little-endian");
+
+	// Type hashes for archived records.
+	template<> constexpr c_hash hash<std::int8_t>() { return "i8"_h; }
+	template<> constexpr c_hash hash<std::uint8_t>() { return "u8"_h; }
+	template<> constexpr c_hash hash<std::int16_t>() { return "i16"_h; }
+	template<> constexpr c_hash hash<std::uint16_t>() { return "u16"_h; }
+	template<> constexpr c_hash hash<std::int32_t>() { return "i32"_h; }
+	template<> constexpr c_hash hash<std::uint32_t>() { return "u32"_h; }
+	template<> constexpr c_hash hash<std::int64_t>() { return "i64"_h; }
+	template<> constexpr c_hash hash<std::uint64_t>() { return "u64"_h; }
+	template<> constexpr c_hash hash<float>() { return "f32"_h; }
+	template<> constexpr c_hash hash<double>() { return "f64"_h; }
+	template<> constexpr c_hash hash<c_hash>() { return "c_hash"_h; }
+	template<> constexpr c_hash hash<c_vec2i>() { return "c_vec2i"_h; }
+	template<> constexpr c_hash hash<c_vec2f>() { return "c_vec2f"_h; }
+	template<> constexpr c_hash hash<c_angle>() { return "c_angle"_h; }
+
+	// Type hash stored with each section. Uses hash<T>(), so new record types only need a hash<T>()
+	// specialization.
+	template<class T>
+	struct s_archive_type
+	{
+		static constexpr c_hash value = hash<T>();
+	};
+
+	template<class T, std::size_t N>
+	struct s_archive_type<c_fixed_vector<T, N>>
+	{
+		static constexpr c_hash value = c_hash(fnv1a_hash("c_fixed_vector", 14, s_archive_type<T>::value.m_hash ^ static_cast<std::uint32_t>(N)));
+	};
+
+	// Copies a record into a section. Records are written as their bytes by default; types with
+	// bytes that do not hold data specialize this so that the same records always give the same file.
+	template<class T>
+	struct s_archive_record
+	{
+		static constexpr bool raw = true;
+
+		static void copy(T const& record, std::byte* out)
+		{
+			std::memcpy(out, &record, sizeof(T));
+		}
+	};
+
+	// Unused capacity and padding are written as zeros, and the count as a 64-bit integer.
+	template<class T, std::size_t N>
+	struct s_archive_record<c_fixed_vector<T, N>>
+	{
+		using vector = c_fixed_vector<T, N>;
+
+		static constexpr bool raw = false;
+		// Read in place, so the count's slot must already be 64 bits wide.
+		static_assert(sizeof(vector::m_count) == sizeof(std::uint64_t), "Archived fixed vectors need a 64-bit count");
+
+		static void copy(vector const& record, std::byte* out)
+		{
+			std::memset(out, 0, sizeof(vector));
+			for (std::size_t i = 0; i < record.m_count; ++i)
+			{
+				s_archive_record<T>::copy(record.m_arr[i], out + offsetof(vector, m_arr) + i * sizeof(T));
+			}
+			std::uint64_t const count = record.m_count;
+			std::memcpy(out + offsetof(vector, m_count), &count, sizeof(count));
+		}
+	};
+
+	// File layout:
+	//   s_archive_header
+	//   section data, each section starting on an archive_alignment boundary
+	//   s_archive_section table, at header.table_offset
+	// Section data and the table are checked with murmur_hash3.
+	constexpr std::uint32_t archive_magic = 0x72617474; // "ttar"
+	constexpr std::uint32_t archive_version = 1;
+	constexpr std::size_t archive_alignment = 16;
+
+	struct s_archive_header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t table_offset;
+		std::uint32_t section_count;
+		std::uint32_t table_checksum;
+	};
+
+	struct s_archive_section
+	{
+		std::uint32_t name;
+		std::uint32_t type;
+		std::uint32_t stride;
+		std::uint32_t checksum;
+		std::uint64_t offset;
+		std::uint64_t count;
+	};
+
+	static_assert(sizeof(s_archive_header) == 24);
+	static_assert(sizeof(s_archive_section) == 32);
+
+	// Streams sections to a file as they are written; only the section table is kept in memory.
+	class c_archive_writer
+	{
+	public:
+		c_archive_writer();
+		// Finishes the archive if finish() was not called.
+		~c_archive_writer();
+
+		// Starts a new archive, replacing any existing file. An archive that is still open is finished
+		// first; if that fails, returns false without opening path.
+		bool open(char const* path);
+
+		// Appends a section of records. Sections are limited to 4 GiB and names should be unique;
+		// readers see the first section with a given name.
+		template<class T>
+		bool write(c_hash name, std::span<T const> records)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Archived records must be trivially copyable");
+			static_assert(alignof(T) <= archive_alignment, "Archived records must fit the section alignment");
+			if constexpr (s_archive_record<T>::raw)
+			{
+				return write(name, s_archive_type<T>::value, sizeof(T), records.data(), records.size());
+			}
+			else
+			{
+				m_buffer.resize(records.size_bytes());
+				for (std::size_t i = 0; i < records.size(); ++i)
+				{
+					s_archive_record<T>::copy(records[i], m_buffer.data() + i * sizeof(T));
+				}
+				return write(name, s_archive_type<T>::value, sizeof(T), m_buffer.data(), records.size());
+			}
+		}
+
+		// Writes the section table and header. Returns false if any write failed.
+		bool finish();
+
+	private:
+		bool write(c_hash name, c_hash type, std::uint32_t stride, void const* data, std::size_t count);
+
+		std::ofstream m_out;
+		std::vector<s_archive_section> m_sections;
+		// Records that are not written raw are copied here first.
+		std::vector<std::byte> m_buffer;
+		std::uint64_t m_offset;
+		bool m_good;
+	};
+
+	// Reads an archive in place. Spans returned by get() point into the mapping and stay valid until
+	// the reader is closed or destroyed.
+	class c_archive_reader
+	{
+	public:
+		// Maps the file and validates the header and section table, and with verify the checksum of
+		// every section.
+		bool open(char const* path, bool verify = true);
+		// Reads from memory the caller keeps alive, aligned to archive_alignment.
+		bool open(std::span<std::byte const> data, bool verify = true);
+		void close();
+
+		// Empty when there is no section with that name, or it holds a different type.
+		template<class T>
+		std::span<T const> get(c_hash name) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Archived records must be trivially copyable");
+			s_archive_section const* section = find(name, s_archive_type<T>::value, sizeof(T));
+			if (section == nullptr)
+			{
+				return {};
+			}
+			return { reinterpret_cast<T const*>(m_data.data() + section->offset), static_cast<std::size_t>(section->count) };
+		}
+
+		bool contains(c_hash name) const;
+		std::span<s_archive_section const> sections() const { return m_sections; }
+
+	private:
+		s_archive_section const* find(c_hash name, c_hash type, std::uint32_t stride) const;
+
+		c_mapped_file m_file;
+		std::span<std::byte const> m_data;
+		std::span<s_archive_section const> m_sections;
+	};
+}
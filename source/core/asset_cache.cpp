@@ -0,0 +1,356 @@
+#include "asset_cache.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <utility>
+
+namespace tt
+{
+	struct s_asset_entry
+	{
+		c_hash name;
+		e_asset_state state;
+		std::uint32_t refs;
+		std::size_t size;
+		std::shared_ptr<void const> object;
+		// Position in m_unused while the asset is loaded and has no handles.
+		std::list<s_asset_entry*>::iterator unused;
+	};
+
+	c_asset_handle::c_asset_handle()
+		: m_cache(nullptr)
+		, m_entry(nullptr)
+	{
+	}
+
+	c_asset_handle::c_asset_handle(c_asset_cache* cache, s_asset_entry* entry)
+		: m_cache(cache)
+		, m_entry(entry)
+	{
+		m_cache->acquire(*m_entry);
+	}
+
+	c_asset_handle::~c_asset_handle()
+	{
+		reset();
+	}
+
+	c_asset_handle::c_asset_handle(c_asset_handle const& other)
+		: m_cache(other.m_cache)
+		, m_entry(other.m_entry)
+	{
+		if (m_entry != nullptr)
+		{
+			m_cache->acquire(*m_entry);
+		}
+	}
+
+	c_asset_handle::c_asset_handle(c_asset_handle&& other) noexcept
+		: m_cache(std::exchange(other.m_cache, nullptr))
+		, m_entry(std::exchange(other.m_entry, nullptr))
+	{
+	}
+
+	c_asset_handle& c_asset_handle::operator=(c_asset_handle const& other)
+	{
+		if (other.m_entry != nullptr)
+		{
+			other.m_cache->acquire(*other.m_entry);
+		}
+		reset();
+		m_cache = other.m_cache;
+		m_entry = other.m_entry;
+		return *this;
+	}
+
+	c_asset_handle& c_asset_handle::operator=(c_asset_handle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			m_cache = std::exchange(other.m_cache, nullptr);
+			m_entry = std::exchange(other.m_entry, nullptr);
+		}
+		return *this;
+	}
+
+	void c_asset_handle::reset()
+	{
+		if (m_entry != nullptr)
+		{
+			m_cache->release(*m_entry);
+			m_cache = nullptr;
+			m_entry = nullptr;
+		}
+	}
+
+	e_asset_state c_asset_handle::state() const
+	{
+		return m_entry != nullptr ? m_entry->state : e_asset_state::failed;
+	}
+
+	c_hash c_asset_handle::name() const
+	{
+		return m_entry != nullptr ? m_entry->name : c_hash();
+	}
+
+	void const* c_asset_handle::object() const
+	{
+		return m_entry != nullptr ? m_entry->object.get() : nullptr;
+	}
+
+	c_asset_cache::c_asset_cache(asset_decoder decoder, std::size_t budget, std::uint32_t threads)
+		: m_decoder(std::move(decoder))
+		, m_budget(budget)
+		, m_size(0)
+		, m_stopping(false)
+	{
+		if (threads == 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+			threads = std::max(1u, threads);
+		}
+		m_threads.reserve(threads);
+		for (std::uint32_t i = 0; i < threads; ++i)
+		{
+			m_threads.emplace_back(&c_asset_cache::work, this);
+		}
+	}
+
+	c_asset_cache::~c_asset_cache()
+	{
+		{
+			std::lock_guard lock(m_job_mutex);
+			m_stopping = true;
+			m_jobs.clear();
+		}
+		m_job_ready.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	c_asset_handle c_asset_cache::request(c_hash name, std::string_view path)
+	{
+		auto const [it, added] = m_entries.try_emplace(name);
+		if (!added && it->second->state != e_asset_state::failed)
+		{
+			++(it->second->state == e_asset_state::loading ? m_stats.joins : m_stats.hits);
+			return c_asset_handle(this, it->second.get());
+		}
+
+		// A failed asset that still has handles is loaded again, and those handles follow it.
+		++m_stats.misses;
+		if (added)
+		{
+			it->second = std::make_unique<s_asset_entry>(s_asset_entry{ name, e_asset_state::loading, 0, 0, nullptr, {} });
+		}
+		it->second->state = e_asset_state::loading;
+		{
+			std::lock_guard lock(m_job_mutex);
+			m_jobs.push_back({ name, std::string(path) });
+		}
+		m_job_ready.notify_one();
+		return c_asset_handle(this, it->second.get());
+	}
+
+	c_asset_handle c_asset_cache::request_now(c_hash name, std::string_view path)
+	{
+		auto const it = m_entries.find(name);
+		if (it != m_entries.end())
+		{
+			c_asset_handle handle = request(name, path);
+			wait(handle);
+			return handle;
+		}
+
+		++m_stats.misses;
+		s_asset_entry& entry = *m_entries.emplace(name, std::make_unique<s_asset_entry>(s_asset_entry{ name, e_asset_state::loading, 0, 0, nullptr, {} })).first->second;
+		c_asset_handle handle(this, &entry);
+		complete(load({ name, std::string(path) }));
+		evict();
+		return handle;
+	}
+
+	std::uint32_t c_asset_cache::poll()
+	{
+		{
+			std::lock_guard lock(m_result_mutex);
+			m_polled.swap(m_results);
+		}
+		std::uint32_t const count = static_cast<std::uint32_t>(m_polled.size());
+		for (s_result& result : m_polled)
+		{
+			complete(std::move(result));
+		}
+		m_polled.clear();
+		if (count != 0)
+		{
+			evict();
+		}
+		return count;
+	}
+
+	void c_asset_cache::wait(c_asset_handle const& handle)
+	{
+		if (handle.state() != e_asset_state::loading)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard lock(m_job_mutex);
+			auto const job = std::find_if(m_jobs.begin(), m_jobs.end(), [&](s_job const& queued) { return queued.name == handle.name(); });
+			if (job != m_jobs.end() && job != m_jobs.begin())
+			{
+				s_job moved = std::move(*job);
+				m_jobs.erase(job);
+				m_jobs.push_front(std::move(moved));
+			}
+		}
+
+		while (true)
+		{
+			poll();
+			if (handle.state() != e_asset_state::loading)
+			{
+				return;
+			}
+			std::unique_lock lock(m_result_mutex);
+			m_result_ready.wait(lock, [this] { return !m_results.empty(); });
+		}
+	}
+
+	void c_asset_cache::set_budget(std::size_t budget)
+	{
+		m_budget = budget;
+		evict();
+	}
+
+	c_asset_cache::s_result c_asset_cache::load(s_job const& job) const
+	{
+		s_result result = { job.name, nullptr, 0 };
+		c_mapped_file file;
+		if (file.open(job.path.c_str()))
+		{
+			result.object = m_decoder(file.data(), result.size);
+		}
+		if (result.object == nullptr)
+		{
+			result.size = 0;
+		}
+		return result;
+	}
+
+	void c_asset_cache::work()
+	{
+		std::vector<std::shared_ptr<void const>> evicted;
+		while (true)
+		{
+			s_job job;
+			bool has_job = false;
+			{
+				std::unique_lock lock(m_job_mutex);
+				m_job_ready.wait(lock, [this] { return m_stopping || !m_jobs.empty() || !m_evicted.empty(); });
+				if (m_stopping)
+				{
+					return;
+				}
+				evicted.swap(m_evicted);
+				if (!m_jobs.empty())
+				{
+					job = std::move(m_jobs.front());
+					m_jobs.pop_front();
+					has_job = true;
+				}
+			}
+
+			evicted.clear();
+			if (!has_job)
+			{
+				continue;
+			}
+			s_result result = load(job);
+			{
+				std::lock_guard lock(m_result_mutex);
+				m_results.push_back(std::move(result));
+			}
+			m_result_ready.notify_one();
+		}
+	}
+
+	// Loading entries are never evicted, so the entry is still there.
+	void c_asset_cache::complete(s_result&& result)
+	{
+		auto const it = m_entries.find(result.name);
+		s_asset_entry& entry = *it->second;
+		entry.state = result.object != nullptr ? e_asset_state::ready : e_asset_state::failed;
+		entry.object = std::move(result.object);
+		entry.size = result.size;
+		m_size += entry.size;
+
+		if (entry.refs == 0)
+		{
+			if (entry.state == e_asset_state::ready)
+			{
+				m_unused.push_front(&entry);
+				entry.unused = m_unused.begin();
+			}
+			else
+			{
+				m_entries.erase(it);
+			}
+		}
+	}
+
+	void c_asset_cache::acquire(s_asset_entry& entry)
+	{
+		if (entry.refs++ == 0 && entry.state == e_asset_state::ready)
+		{
+			m_unused.erase(entry.unused);
+		}
+	}
+
+	// Failed assets are dropped with their last handle so the next request tries again.
+	void c_asset_cache::release(s_asset_entry& entry)
+	{
+		if (--entry.refs != 0)
+		{
+			return;
+		}
+		if (entry.state == e_asset_state::ready)
+		{
+			m_unused.push_front(&entry);
+			entry.unused = m_unused.begin();
+			evict();
+		}
+		else if (entry.state == e_asset_state::failed)
+		{
+			m_entries.erase(entry.name);
+		}
+	}
+
+	// Large assets can take a while to free, so evicted assets are destroyed on a loader thread.
+	void c_asset_cache::evict()
+	{
+		std::size_t const evicted = m_stats.evictions;
+		while (m_size > m_budget && !m_unused.empty())
+		{
+			s_asset_entry* const entry = m_unused.back();
+			m_unused.pop_back();
+			m_size -= entry->size;
+			++m_stats.evictions;
+			m_evicting.push_back(std::move(entry->object));
+			m_entries.erase(entry->name);
+		}
+		if (m_stats.evictions != evicted)
+		{
+			{
+				std::lock_guard lock(m_job_mutex);
+				m_evicted.insert(m_evicted.end(), std::make_move_iterator(m_evicting.begin()), std::make_move_iterator(m_evicting.end()));
+			}
+			m_evicting.clear();
+			m_job_ready.notify_one();
+		}
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "core/hash.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tt
+{
+	class c_asset_cache;
+	struct s_asset_entry;
+
+	// Turns a file's contents into an asset and sets size to the bytes it should count against the
+	// cache budget. Returns null on failure. Runs on the loader threads, several at a time.
+	using asset_decoder = std::function<std::shared_ptr<void const>(std::span<std::byte const> data, std::size_t& size)>;
+
+	enum class e_asset_state : std::uint8_t
+	{
+		loading,
+		ready,
+		failed,
+	};
+
+	struct s_asset_cache_stats
+	{
+		// Requests for an asset that was already loaded.
+		std::uint64_t hits = 0;
+		// Requests that joined a load already in flight instead of starting another.
+		std::uint64_t joins = 0;
+		// Requests that started a load, including retries of failed loads.
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+	};
+
+	// Keeps an asset in the cache while any handle to it exists. Handles belong to the main thread and
+	// must not outlive their cache.
+	class c_asset_handle
+	{
+	public:
+		c_asset_handle();
+		~c_asset_handle();
+		c_asset_handle(c_asset_handle const& other);
+		c_asset_handle(c_asset_handle&& other) noexcept;
+		c_asset_handle& operator=(c_asset_handle const& other);
+		c_asset_handle& operator=(c_asset_handle&& other) noexcept;
+
+		void reset();
+
+		bool valid() const { return m_entry != nullptr; }
+		e_asset_state state() const;
+		bool ready() const { return state() == e_asset_state::ready; }
+		c_hash name() const;
+
+		// Null until ready. T must be the type the cache's decoder produces.
+		template<class T>
+		T const* get() const
+		{
+			return static_cast<T const*>(object());
+		}
+
+	private:
+		friend class c_asset_cache;
+
+		c_asset_handle(c_asset_cache* cache, s_asset_entry* entry);
+		void const* object() const;
+
+		c_asset_cache* m_cache;
+		s_asset_entry* m_entry;
+	};
+
+	// Shared cache of decoded assets keyed by name. Files are mapped and decoded on loader threads;
+	// finished loads wait in a queue until poll() publishes them on the main thread, so handles only
+	// change state inside poll() or wait(). Assets without handles stay cached until the total size
+	// exceeds the budget, then the least recently released are evicted. Only decoding and freeing
+	// evicted assets happen on the loader threads; everything else is main-thread only.
+	class c_asset_cache
+	{
+	public:
+		// 0 threads uses one per hardware thread, less one for the main thread.
+		c_asset_cache(asset_decoder decoder, std::size_t budget, std::uint32_t threads = 0);
+		// Waits for the loader threads to finish their current file; queued loads are dropped.
+		~c_asset_cache();
+		c_asset_cache(c_asset_cache const&) = delete;
+		c_asset_cache& operator=(c_asset_cache const&) = delete;
+
+		// Returns a handle to the asset called name, starting a load of path if it is neither cached
+		// nor in flight. path is ignored when the name is already cached or in flight. An asset whose
+		// load failed is loaded again, and handles still holding it go back to loading.
+		c_asset_handle request(c_hash name, std::string_view path);
+		// Loads the asset on the calling thread if it is not already cached. Meant for loading
+		// screens and assets that are needed this frame.
+		c_asset_handle request_now(c_hash name, std::string_view path);
+
+		// Publishes finished loads. Returns how many were published.
+		std::uint32_t poll();
+		// Blocks until the handle's asset has finished loading, then publishes it and anything else
+		// that finished. A load that has not started yet is moved to the front of the queue.
+		void wait(c_asset_handle const& handle);
+
+		void set_budget(std::size_t budget);
+		std::size_t budget() const { return m_budget; }
+		// Bytes held by loaded assets, with or without handles.
+		std::size_t size() const { return m_size; }
+		std::uint32_t count() const { return static_cast<std::uint32_t>(m_entries.size()); }
+		s_asset_cache_stats const& stats() const { return m_stats; }
+
+	private:
+		friend class c_asset_handle;
+
+		struct s_job
+		{
+			c_hash name;
+			std::string path;
+		};
+
+		struct s_result
+		{
+			c_hash name;
+			std::shared_ptr<void const> object;
+			std::size_t size;
+		};
+
+		s_result load(s_job const& job) const;
+		void work();
+		void complete(s_result&& result);
+		void acquire(s_asset_entry& entry);
+		void release(s_asset_entry& entry);
+		void evict();
+
+		asset_decoder m_decoder;
+		std::size_t m_budget;
+		std::size_t m_size;
+		s_asset_cache_stats m_stats;
+
+		std::unordered_map<c_hash, std::unique_ptr<s_asset_entry>, s_hash_hasher> m_entries;
+		// Loaded assets without handles, most recently released first.
+		std::list<s_asset_entry*> m_unused;
+
+		std::mutex m_job_mutex;
+		std::condition_variable m_job_ready;
+		std::deque<s_job> m_jobs;
+		// Evicted assets waiting to be destroyed by a loader thread.
+		std::vector<std::shared_ptr<void const>> m_evicted;
+		std::vector<std::shared_ptr<void const>> m_evicting;
+		bool m_stopping;
+
+		std::mutex m_result_mutex;
+		std::condition_variable m_result_ready;
+		std::vector<s_result> m_results;
+		std::vector<s_result> m_polled;
+
+		std::vector<std::thread> m_threads;
+	};
+}
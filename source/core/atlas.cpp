@@ -0,0 +1,277 @@
+#include "atlas.h"
+#include "archive.h"
+#include <algorithm>
+#include <numeric>
+
+namespace tt
+{
+	namespace
+	{
+		// Bump when the packer changes, so old cache files are repacked.
+		constexpr std::uint32_t atlas_version = 1;
+	}
+
+	c_atlas::c_atlas()
+		: m_key(0)
+		, m_packed(false)
+	{
+	}
+
+	bool c_atlas::pack(std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding)
+	{
+		m_entries.clear();
+		m_pages.clear();
+		m_lookup.clear();
+		m_key = key(inputs, page_size, padding);
+		m_packed = false;
+
+		m_entries.resize(inputs.size());
+		for (std::size_t i = 0; i < inputs.size(); ++i)
+		{
+			s_atlas_input const& input = inputs[i];
+			if (input.size.x() < 0 || input.size.y() < 0 || input.size.x() > page_size.x() || input.size.y() > page_size.y())
+			{
+				m_entries.clear();
+				return false;
+			}
+			m_entries[i] = { input.name.m_hash, 0, 0, 0, input.size.x(), input.size.y() };
+		}
+
+		// Tallest first keeps the skyline flat; ties on width, then input order.
+		std::vector<std::uint32_t> order(inputs.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+			if (inputs[a].size.y() != inputs[b].size.y())
+			{
+				return inputs[a].size.y() > inputs[b].size.y();
+			}
+			return inputs[a].size.x() > inputs[b].size.x();
+		});
+
+		// Padded rectangles go on pages grown by the padding, so a rectangle can still touch the
+		// right and bottom edges of the real page.
+		c_vec2i const padded_page = { page_size.x() + padding, page_size.y() + padding };
+		std::vector<std::vector<s_segment>> skylines;
+		for (std::uint32_t index : order)
+		{
+			s_atlas_entry& entry = m_entries[index];
+			if (entry.width == 0 || entry.height == 0)
+			{
+				continue;
+			}
+
+			c_vec2i position;
+			std::uint32_t page = 0;
+			while (page < skylines.size() && !place(skylines[page], entry.width + padding, entry.height + padding, padded_page, position))
+			{
+				++page;
+			}
+			if (page == skylines.size())
+			{
+				skylines.push_back({ { 0, 0, padded_page.x() } });
+				m_pages.push_back({ page_size.x(), 0 });
+				place(skylines.back(), entry.width + padding, entry.height + padding, padded_page, position);
+			}
+
+			entry.page = page;
+			entry.left = position.x();
+			entry.top = position.y();
+			m_pages[page].y() = std::max(m_pages[page].y(), entry.top + entry.height);
+		}
+
+		index();
+		m_packed = true;
+		return true;
+	}
+
+	bool c_atlas::pack_cached(char const* path, std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding)
+	{
+		if (load(path, inputs, page_size, padding))
+		{
+			return true;
+		}
+		if (!pack(inputs, page_size, padding))
+		{
+			return false;
+		}
+		save(path);
+		return true;
+	}
+
+	bool c_atlas::load(char const* path, std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding)
+	{
+		c_archive_reader reader;
+		if (!reader.open(path))
+		{
+			return false;
+		}
+
+		std::uint32_t const expected_key = key(inputs, page_size, padding);
+		std::span<std::uint32_t const> const keys = reader.get<std::uint32_t>("key"_h);
+		std::span<c_vec2i const> const pages = reader.get<c_vec2i>("pages"_h);
+		std::span<s_atlas_entry const> const entries = reader.get<s_atlas_entry>("entries"_h);
+		if (keys.size() != 1 || keys[0] != expected_key || entries.size() != inputs.size())
+		{
+			return false;
+		}
+
+		// The key is only 32 bits, so the entries are checked against the inputs as well.
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			s_atlas_entry const& entry = entries[i];
+			s_atlas_input const& input = inputs[i];
+			if (entry.name != input.name.m_hash || entry.width != input.size.x() || entry.height != input.size.y()
+				|| ((entry.width != 0 && entry.height != 0) && entry.page >= pages.size()))
+			{
+				return false;
+			}
+		}
+
+		m_entries.assign(entries.begin(), entries.end());
+		m_pages.assign(pages.begin(), pages.end());
+		m_key = expected_key;
+		m_packed = true;
+		index();
+		return true;
+	}
+
+	bool c_atlas::save(char const* path) const
+	{
+		c_archive_writer writer;
+		if (!m_packed || !writer.open(path))
+		{
+			return false;
+		}
+		bool const written = writer.write<std::uint32_t>("key"_h, std::span(&m_key, 1))
+			&& writer.write<c_vec2i>("pages"_h, m_pages)
+			&& writer.write<s_atlas_entry>("entries"_h, m_entries);
+		return writer.finish() && written;
+	}
+
+	s_atlas_entry const* c_atlas::find(c_hash name) const
+	{
+		auto const it = m_lookup.find(name);
+		return it != m_lookup.end() ? &m_entries[it->second] : nullptr;
+	}
+
+	bool c_atlas::compose(std::uint32_t page, std::span<sf::Image const* const> images, sf::Image& out) const
+	{
+		if (page >= m_pages.size() || images.size() != m_entries.size())
+		{
+			return false;
+		}
+
+		out.create(static_cast<unsigned int>(m_pages[page].x()), static_cast<unsigned int>(m_pages[page].y()), sf::Color::Transparent);
+		for (std::size_t i = 0; i < m_entries.size(); ++i)
+		{
+			s_atlas_entry const& entry = m_entries[i];
+			if (entry.page != page || entry.width == 0 || entry.height == 0 || images[i] == nullptr)
+			{
+				continue;
+			}
+			sf::Vector2u const size = images[i]->getSize();
+			if (size.x != static_cast<unsigned int>(entry.width) || size.y != static_cast<unsigned int>(entry.height))
+			{
+				return false;
+			}
+			out.copy(*images[i], static_cast<unsigned int>(entry.left), static_cast<unsigned int>(entry.top));
+		}
+		return true;
+	}
+
+	std::uint32_t c_atlas::key(std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding)
+	{
+		std::vector<std::uint32_t> words;
+		words.reserve(5 + inputs.size() * 3);
+		words.push_back(atlas_version);
+		words.push_back(static_cast<std::uint32_t>(page_size.x()));
+		words.push_back(static_cast<std::uint32_t>(page_size.y()));
+		words.push_back(static_cast<std::uint32_t>(padding));
+		words.push_back(static_cast<std::uint32_t>(inputs.size()));
+		for (s_atlas_input const& input : inputs)
+		{
+			words.push_back(input.name.m_hash);
+			words.push_back(static_cast<std::uint32_t>(input.size.x()));
+			words.push_back(static_cast<std::uint32_t>(input.size.y()));
+		}
+		return murmur_hash3(reinterpret_cast<char const*>(words.data()), static_cast<std::uint32_t>(words.size() * sizeof(std::uint32_t)));
+	}
+
+	// Bottom-left skyline: the rectangle goes where its top edge ends lowest, preferring the left.
+	// The skyline is a list of segments sorted by x that covers the page width.
+	bool c_atlas::place(std::vector<s_segment>& skyline, std::int32_t width, std::int32_t height, c_vec2i page_size, c_vec2i& position)
+	{
+		std::size_t best = skyline.size();
+		std::int32_t best_y = 0;
+		std::int32_t best_bottom = page_size.y() + 1;
+		for (std::size_t i = 0; i < skyline.size() && skyline[i].x + width <= page_size.x(); ++i)
+		{
+			// The rectangle rests on the highest segment it spans.
+			std::int32_t y = 0;
+			std::int32_t const right = skyline[i].x + width;
+			for (std::size_t j = i; j < skyline.size() && skyline[j].x < right; ++j)
+			{
+				y = std::max(y, skyline[j].y);
+			}
+			if (y + height <= page_size.y() && y + height < best_bottom)
+			{
+				best = i;
+				best_y = y;
+				best_bottom = y + height;
+			}
+		}
+		if (best == skyline.size())
+		{
+			return false;
+		}
+
+		// Replace the spanned segments with one at the rectangle's bottom edge, keeping any part of
+		// the last one that sticks out to the right.
+		std::int32_t const left = skyline[best].x;
+		std::int32_t const right = left + width;
+		std::size_t end = best;
+		while (end < skyline.size() && skyline[end].x + skyline[end].width <= right)
+		{
+			++end;
+		}
+		if (end < skyline.size() && skyline[end].x < right)
+		{
+			skyline[end].width -= right - skyline[end].x;
+			skyline[end].x = right;
+		}
+		if (end == best)
+		{
+			skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(best), { left, best_bottom, width });
+		}
+		else
+		{
+			skyline[best] = { left, best_bottom, width };
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(best) + 1, skyline.begin() + static_cast<std::ptrdiff_t>(end));
+		}
+
+		// Merge with neighbours at the same height.
+		if (best + 1 < skyline.size() && skyline[best + 1].y == best_bottom)
+		{
+			skyline[best].width += skyline[best + 1].width;
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(best) + 1);
+		}
+		if (best > 0 && skyline[best - 1].y == best_bottom)
+		{
+			skyline[best - 1].width += skyline[best].width;
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(best));
+		}
+
+		position = { left, best_y };
+		return true;
+	}
+
+	void c_atlas::index()
+	{
+		m_lookup.clear();
+		m_lookup.reserve(m_entries.size());
+		for (std::uint32_t i = 0; i < m_entries.size(); ++i)
+		{
+			m_lookup.try_emplace(m_entries[i].name, i);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/hash.h"
+#include "core/math.h"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace tt
+{
+	struct s_atlas_input
+	{
+		c_hash name;
+		c_vec2i size;
+	};
+
+	// Where an input landed. Stored as-is in cache files.
+	struct s_atlas_entry
+	{
+		std::uint32_t name;
+		std::uint32_t page;
+		std::int32_t left;
+		std::int32_t top;
+		std::int32_t width;
+		std::int32_t height;
+	};
+
+	template<> constexpr c_hash hash<s_atlas_entry>() { return "s_atlas_entry"_h; }
+
+	// Packs rectangles into fixed-width pages with a bottom-left skyline packer. Inputs are placed
+	// tallest first, each on the first page it fits, so the layout depends only on the input sizes
+	// and order. Pages are cropped to their used height.
+	class c_atlas
+	{
+	public:
+		c_atlas();
+
+		// padding is left empty to the right of and below each rectangle. Fails if a rectangle is
+		// larger than a page.
+		bool pack(std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding = 1);
+
+		// Loads the layout from a cache file written by save() for the same inputs and settings, or
+		// packs and saves it when the file is missing or stale. Returns false only if packing fails;
+		// a cache that cannot be written is not an error.
+		bool pack_cached(char const* path, std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding = 1);
+		bool load(char const* path, std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding = 1);
+		// Fails without touching the file when no layout has been packed or loaded.
+		bool save(char const* path) const;
+
+		// Nullptr for names that were not packed. Empty rectangles are not placed and have no page.
+		s_atlas_entry const* find(c_hash name) const;
+		// In input order.
+		std::span<s_atlas_entry const> entries() const { return m_entries; }
+		std::span<c_vec2i const> pages() const { return m_pages; }
+
+		// Copies images[i] to entries()[i] for every entry on the page. images must be in input order
+		// and match the packed sizes; null images leave their rectangle transparent.
+		bool compose(std::uint32_t page, std::span<sf::Image const* const> images, sf::Image& out) const;
+
+		// Identifies a set of inputs and settings; a cache file is reused only when it matches.
+		static std::uint32_t key(std::span<s_atlas_input const> inputs, c_vec2i page_size, std::int32_t padding);
+
+	private:
+		struct s_segment
+		{
+			std::int32_t x;
+			std::int32_t y;
+			std::int32_t width;
+		};
+
+		// Returns false when the rectangle does not fit on the page.
+		static bool place(std::vector<s_segment>& skyline, std::int32_t width, std::int32_t height, c_vec2i page_size, c_vec2i& position);
+		void index();
+
+		std::vector<s_atlas_entry> m_entries;
+		std::vector<c_vec2i> m_pages;
+		std::unordered_map<c_hash, std::uint32_t, s_hash_hasher> m_lookup;
+		std::uint32_t m_key;
+		// Whether the last pack() or load() succeeded.
+		bool m_packed;
+	};
+}
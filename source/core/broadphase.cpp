@@ -0,0 +1,232 @@
+#include "broadphase.h"
+#include <algorithm>
+
+namespace tt
+{
+	c_broadphase::c_broadphase(std::int32_t cell_size)
+		: m_cell_size(cell_size > 0 ? cell_size : 1)
+		, m_stamp(0)
+	{
+	}
+
+	c_broadphase::id_t c_broadphase::add(c_vec2i center, c_vec2i extents)
+	{
+		id_t id;
+		if (!m_free.empty())
+		{
+			id = m_free.back();
+			m_free.pop_back();
+			m_centers[id] = center;
+			m_extents[id] = extents;
+		}
+		else
+		{
+			id = static_cast<id_t>(m_centers.size());
+			m_centers.push_back(center);
+			m_extents.push_back(extents);
+			m_ranges.push_back({});
+			m_stamps.push_back(0);
+		}
+		s_cell_range const range = cell_range(center, extents);
+		m_ranges[id] = range;
+		for (std::int32_t y = range.y0; y <= range.y1; ++y)
+		{
+			for (std::int32_t x = range.x0; x <= range.x1; ++x)
+			{
+				insert_cell(x, y, id);
+			}
+		}
+		return id;
+	}
+
+	void c_broadphase::move(id_t id, c_vec2i center, c_vec2i extents)
+	{
+		m_centers[id] = center;
+		m_extents[id] = extents;
+		s_cell_range const old_range = m_ranges[id];
+		s_cell_range const new_range = cell_range(center, extents);
+		if (old_range == new_range)
+		{
+			return;
+		}
+		for (std::int32_t y = old_range.y0; y <= old_range.y1; ++y)
+		{
+			for (std::int32_t x = old_range.x0; x <= old_range.x1; ++x)
+			{
+				if (!new_range.contains(x, y))
+				{
+					erase_cell(x, y, id);
+				}
+			}
+		}
+		for (std::int32_t y = new_range.y0; y <= new_range.y1; ++y)
+		{
+			for (std::int32_t x = new_range.x0; x <= new_range.x1; ++x)
+			{
+				if (!old_range.contains(x, y))
+				{
+					insert_cell(x, y, id);
+				}
+			}
+		}
+		m_ranges[id] = new_range;
+	}
+
+	void c_broadphase::remove(id_t id)
+	{
+		s_cell_range const range = m_ranges[id];
+		for (std::int32_t y = range.y0; y <= range.y1; ++y)
+		{
+			for (std::int32_t x = range.x0; x <= range.x1; ++x)
+			{
+				erase_cell(x, y, id);
+			}
+		}
+		m_ranges[id] = { 0, 0, -1, -1 };
+		m_free.push_back(id);
+	}
+
+	void c_broadphase::query(c_vec2i center, c_vec2i extents, std::vector<id_t>& out)
+	{
+		std::uint32_t const stamp = next_stamp();
+		m_candidates.clear();
+		m_candidate_centers.clear();
+		m_candidate_extents.clear();
+		s_cell_range const range = cell_range(center, extents);
+		for (std::int32_t y = range.y0; y <= range.y1; ++y)
+		{
+			for (std::int32_t x = range.x0; x <= range.x1; ++x)
+			{
+				auto it = m_cells.find(cell_key(x, y));
+				if (it == m_cells.end())
+				{
+					continue;
+				}
+				for (id_t id : it->second)
+				{
+					if (m_stamps[id] != stamp)
+					{
+						m_stamps[id] = stamp;
+						m_candidates.push_back(id);
+						m_candidate_centers.push_back(m_centers[id]);
+						m_candidate_extents.push_back(m_extents[id]);
+					}
+				}
+			}
+		}
+		m_hits.resize(m_candidates.size());
+		std::size_t const hit_count = overlaps(center, extents, m_candidate_centers, m_candidate_extents, m_hits.data());
+		for (std::size_t i = 0; i < hit_count; ++i)
+		{
+			out.push_back(m_candidates[m_hits[i]]);
+		}
+	}
+
+	void c_broadphase::pairs(std::vector<std::pair<id_t, id_t>>& out)
+	{
+		for (auto const& [key, ids] : m_cells)
+		{
+			if (ids.size() < 2)
+			{
+				continue;
+			}
+			std::int32_t const cell_x = static_cast<std::int32_t>(key >> 32);
+			std::int32_t const cell_y = static_cast<std::int32_t>(key & 0xffffffff);
+			m_candidate_centers.clear();
+			m_candidate_extents.clear();
+			for (id_t id : ids)
+			{
+				m_candidate_centers.push_back(m_centers[id]);
+				m_candidate_extents.push_back(m_extents[id]);
+			}
+			m_hits.resize(ids.size());
+			std::span<c_vec2i const> const centers = m_candidate_centers;
+			std::span<c_vec2i const> const extents = m_candidate_extents;
+			for (std::size_t i = 0; i + 1 < ids.size(); ++i)
+			{
+				c_vec2i const a_center = centers[i];
+				c_vec2i const a_extents = extents[i];
+				std::size_t const hit_count = overlaps(a_center, a_extents, centers.subspan(i + 1), extents.subspan(i + 1), m_hits.data());
+				for (std::size_t h = 0; h < hit_count; ++h)
+				{
+					std::size_t const j = i + 1 + m_hits[h];
+					// A pair shares every cell its intersection touches. Report it only from the cell
+					// holding the intersection's min corner so it comes out once.
+					c_vec2i const b_center = centers[j];
+					c_vec2i const b_extents = extents[j];
+					std::int32_t const min_x = std::max(a_center.x() - a_extents.x() / 2, b_center.x() - b_extents.x() / 2);
+					std::int32_t const min_y = std::max(a_center.y() - a_extents.y() / 2, b_center.y() - b_extents.y() / 2);
+					if (cell_coord(min_x) != cell_x || cell_coord(min_y) != cell_y)
+					{
+						continue;
+					}
+					id_t const a = ids[i];
+					id_t const b = ids[j];
+					out.emplace_back(std::min(a, b), std::max(a, b));
+				}
+			}
+		}
+	}
+
+	c_vec2i c_broadphase::center(id_t id) const
+	{
+		return m_centers[id];
+	}
+
+	c_vec2i c_broadphase::extents(id_t id) const
+	{
+		return m_extents[id];
+	}
+
+	c_broadphase::s_cell_range c_broadphase::cell_range(c_vec2i center, c_vec2i extents) const
+	{
+		return {
+			cell_coord(center.x() - extents.x() / 2),
+			cell_coord(center.y() - extents.y() / 2),
+			cell_coord(center.x() + extents.x() / 2),
+			cell_coord(center.y() + extents.y() / 2),
+		};
+	}
+
+	std::int32_t c_broadphase::cell_coord(std::int32_t v) const
+	{
+		// Floor division so cells stay the same size on both sides of the origin.
+		return v >= 0 ? v / m_cell_size : -((-(v + 1)) / m_cell_size) - 1;
+	}
+
+	std::uint64_t c_broadphase::cell_key(std::int32_t x, std::int32_t y)
+	{
+		return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+	}
+
+	void c_broadphase::insert_cell(std::int32_t x, std::int32_t y, id_t id)
+	{
+		m_cells[cell_key(x, y)].push_back(id);
+	}
+
+	void c_broadphase::erase_cell(std::int32_t x, std::int32_t y, id_t id)
+	{
+		auto it = m_cells.find(cell_key(x, y));
+		if (it == m_cells.end())
+		{
+			return;
+		}
+		std::vector<id_t>& ids = it->second;
+		auto found = std::find(ids.begin(), ids.end(), id);
+		if (found != ids.end())
+		{
+			*found = ids.back();
+			ids.pop_back();
+		}
+	}
+
+	std::uint32_t c_broadphase::next_stamp()
+	{
+		if (++m_stamp == 0)
+		{
+			std::fill(m_stamps.begin(), m_stamps.end(), 0);
+			m_stamp = 1;
+		}
+		return m_stamp;
+	}
+}
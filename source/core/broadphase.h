@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/math.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tt
+{
+	// Uniform grid broadphase over center/extents boxes, using the same overlap rule as overlaps().
+	// Boxes are stored in every cell they touch, so cell_size should be around the size of a typical
+	// box. Extents must not be negative. Emptied cells are kept so boxes moving back and forth do not
+	// reallocate them.
+	class c_broadphase
+	{
+	public:
+		using id_t = std::uint32_t;
+
+		explicit c_broadphase(std::int32_t cell_size);
+
+		id_t add(c_vec2i center, c_vec2i extents);
+		// Only touches the grid when the box crosses into a different set of cells.
+		void move(id_t id, c_vec2i center, c_vec2i extents);
+		void remove(id_t id);
+
+		// Appends the ids of every box overlapping the given box.
+		void query(c_vec2i center, c_vec2i extents, std::vector<id_t>& out);
+		// Appends every overlapping pair once, as (lower id, higher id).
+		void pairs(std::vector<std::pair<id_t, id_t>>& out);
+
+		c_vec2i center(id_t id) const;
+		c_vec2i extents(id_t id) const;
+
+	private:
+		struct s_cell_range
+		{
+			std::int32_t x0;
+			std::int32_t y0;
+			std::int32_t x1;
+			std::int32_t y1;
+
+			bool contains(std::int32_t x, std::int32_t y) const
+			{
+				return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+			}
+
+			bool operator==(s_cell_range const& other) const = default;
+		};
+
+		s_cell_range cell_range(c_vec2i center, c_vec2i extents) const;
+		std::int32_t cell_coord(std::int32_t v) const;
+		static std::uint64_t cell_key(std::int32_t x, std::int32_t y);
+		void insert_cell(std::int32_t x, std::int32_t y, id_t id);
+		void erase_cell(std::int32_t x, std::int32_t y, id_t id);
+		std::uint32_t next_stamp();
+
+		std::int32_t m_cell_size;
+		std::unordered_map<std::uint64_t, std::vector<id_t>> m_cells;
+		std::vector<c_vec2i> m_centers;
+		std::vector<c_vec2i> m_extents;
+		std::vector<s_cell_range> m_ranges;
+		std::vector<id_t> m_free;
+
+		// Scratch reused between queries so they do not allocate once warmed up.
+		std::vector<std::uint32_t> m_stamps;
+		std::uint32_t m_stamp;
+		std::vector<id_t> m_candidates;
+		std::vector<c_vec2i> m_candidate_centers;
+		std::vector<c_vec2i> m_candidate_extents;
+		std::vector<std::uint32_t> m_hits;
+	};
+}
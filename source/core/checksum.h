@@ -0,0 +1,161 @@
+#pragma once
+
+#include "core/ds.h"
+#include "core/hash.h"
+#include "core/math.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace tt
+{
+	// Hashes of simulation values for state checksums. Each takes the running hash as seed, so fields
+	// chain: state_hash(angle, state_hash(position)). Every 32-bit word goes through one murmur_hash3
+	// block round; the avalanche step is left to c_state_checksum, which mixes each object hash once.
+	// Floats hash by bit pattern.
+	constexpr std::uint32_t state_hash(std::uint32_t value, std::uint32_t seed = 0)
+	{
+		std::uint32_t k = value * 0xcc9e2d51;
+		k = std::rotl(k, 15) * 0x1b873593;
+		return std::rotl(seed ^ k, 13) * 5 + 0xe6546b64;
+	}
+
+	constexpr std::uint32_t state_hash(std::int32_t value, std::uint32_t seed = 0)
+	{
+		return state_hash(static_cast<std::uint32_t>(value), seed);
+	}
+
+	constexpr std::uint32_t state_hash(float value, std::uint32_t seed = 0)
+	{
+		return state_hash(std::bit_cast<std::uint32_t>(value), seed);
+	}
+
+	constexpr std::uint32_t state_hash(c_hash value, std::uint32_t seed = 0)
+	{
+		return state_hash(value.m_hash, seed);
+	}
+
+	constexpr std::uint32_t state_hash(c_angle value, std::uint32_t seed = 0)
+	{
+		return state_hash(static_cast<std::uint32_t>(static_cast<std::uint16_t>(value.angle())), seed);
+	}
+
+	template<class T>
+	constexpr std::uint32_t state_hash(c_vec2<T> value, std::uint32_t seed = 0)
+	{
+		return state_hash(value.y(), state_hash(value.x(), seed));
+	}
+
+	// Only the first count() elements are hashed; stale slots past the end do not matter.
+	template<class T, std::size_t N>
+	std::uint32_t state_hash(c_fixed_vector<T, N> const& values, std::uint32_t seed = 0)
+	{
+		std::uint32_t hash = state_hash(static_cast<std::uint32_t>(values.count()), seed);
+		for (T const& value : values)
+		{
+			hash = state_hash(value, hash);
+		}
+		return hash;
+	}
+
+	// Order-independent checksum over indexed objects. Each object contributes a 64-bit term mixed
+	// from its index and hash, and the total is the sum of all terms, so changing one object costs
+	// one subtraction and one addition instead of rehashing the world. Objects that are not set
+	// hash to 0.
+	class c_state_checksum
+	{
+	public:
+		explicit c_state_checksum(std::uint32_t count = 0)
+			: m_total(0)
+		{
+			resize(count);
+		}
+
+		// New objects start with hash 0.
+		void resize(std::uint32_t count)
+		{
+			for (std::uint32_t i = count; i < m_hashes.size(); ++i)
+			{
+				m_total -= term(i, m_hashes[i]);
+			}
+			for (std::uint32_t i = static_cast<std::uint32_t>(m_hashes.size()); i < count; ++i)
+			{
+				m_total += term(i, 0);
+			}
+			m_hashes.resize(count, 0);
+		}
+
+		void set(std::uint32_t index, std::uint32_t hash)
+		{
+			m_total += term(index, hash) - term(index, m_hashes[index]);
+			m_hashes[index] = hash;
+		}
+
+		// Recomputes every object's hash as hash_of(index) on the given number of threads (0 uses
+		// one per hardware thread). The total does not depend on the thread count. hash_of is called
+		// concurrently with different indices and in no particular order, so it must be thread-safe
+		// and free of side effects: it should only read the object it is given.
+		template<class Hash>
+		void rebuild(Hash const& hash_of, std::uint32_t threads = 0)
+		{
+			std::uint32_t const count = static_cast<std::uint32_t>(m_hashes.size());
+			if (threads == 0)
+			{
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			}
+			threads = std::clamp(count / min_objects_per_thread, 1u, threads);
+
+			std::vector<std::uint64_t> partial(threads, 0);
+			auto work = [&](std::uint32_t t) {
+				std::uint32_t const begin = static_cast<std::uint32_t>(std::uint64_t{ count } * t / threads);
+				std::uint32_t const end = static_cast<std::uint32_t>(std::uint64_t{ count } * (t + 1) / threads);
+				std::uint64_t sum = 0;
+				for (std::uint32_t i = begin; i < end; ++i)
+				{
+					m_hashes[i] = hash_of(i);
+					sum += term(i, m_hashes[i]);
+				}
+				partial[t] = sum;
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(threads - 1);
+			for (std::uint32_t t = 1; t < threads; ++t)
+			{
+				workers.emplace_back(work, t);
+			}
+			work(0);
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+
+			m_total = 0;
+			for (std::uint64_t sum : partial)
+			{
+				m_total += sum;
+			}
+		}
+
+		std::uint64_t total() const { return m_total; }
+		std::uint32_t count() const { return static_cast<std::uint32_t>(m_hashes.size()); }
+		std::uint32_t hash(std::uint32_t index) const { return m_hashes[index]; }
+		// Per-object hashes, for finding which objects differ once totals disagree.
+		std::span<std::uint32_t const> hashes() const { return m_hashes; }
+
+	private:
+		static constexpr std::uint32_t min_objects_per_thread = 4096;
+
+		static std::uint64_t term(std::uint32_t index, std::uint32_t hash)
+		{
+			std::uint64_t state = (static_cast<std::uint64_t>(index) << 32) | hash;
+			return splitmix64(state);
+		}
+
+		std::vector<std::uint32_t> m_hashes;
+		std::uint64_t m_total;
+	};
+}
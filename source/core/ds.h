@@ -4,6 +4,8 @@
 #include <utility>
 #include <iterator>
 #include <cstddef>
+#include <atomic>
+#include <cstdint>
 
 namespace tt
 {
@@ -209,8 +211,64 @@ namespace tt
 		}
 
 	private:
+		// Archives copy only the used elements, so they need the layout.
+		template<class U>
+		friend struct s_archive_record;
+
 		std::array<T, N> m_arr;
 		size_t m_count;
 	};
 
+	// Wait-free single producer, single consumer triple buffer. The writer fills write() and calls
+	// publish(); the reader calls read() to get the newest published value. Neither side ever waits
+	// on the other, and a value is only touched by one side at a time.
+	template<class T>
+	class c_triple_buffer
+	{
+	public:
+		c_triple_buffer()
+			: m_middle(1)
+			, m_write(0)
+			, m_read(2)
+		{
+		}
+
+		// Writer side.
+		T& write()
+		{
+			return m_slots[m_write].value;
+		}
+
+		void publish()
+		{
+			m_write = m_middle.exchange(static_cast<std::uint8_t>(m_write | fresh), std::memory_order_acq_rel) & index_mask;
+		}
+
+		// Reader side. The returned value belongs to the reader, which may modify it, and stays valid
+		// until the next read().
+		T& read()
+		{
+			if (m_middle.load(std::memory_order_relaxed) & fresh)
+			{
+				m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & index_mask;
+			}
+			return m_slots[m_read].value;
+		}
+
+	private:
+		static constexpr std::uint8_t index_mask = 3;
+		static constexpr std::uint8_t fresh = 4;
+
+		// Slots and indices on separate cache lines so the two sides do not false-share.
+		struct alignas(64) s_slot
+		{
+			T value;
+		};
+
+		s_slot m_slots[3];
+		alignas(64) std::atomic<std::uint8_t> m_middle;
+		alignas(64) std::uint8_t m_write;
+		alignas(64) std::uint8_t m_read;
+	};
+
 } // namespace tt
\ No newline at end of file
@@ -145,6 +145,7 @@ namespace tt
 	constexpr c_hash hash()
 	{
 		static_assert(std::is_same<T, T>{} == false, "Invalid type for hash");
+		return {};
 	}
 
 	// Static assertions (can be moved to a test file if preferred)
@@ -1,89 +1,211 @@
 #include "input.h"
+#include "input_record.h"
 
 namespace tt
 {
-	void c_input::add(sf::Keyboard::Key key, c_hash action)
+	c_input::c_input()
+		: m_recorder(nullptr)
 	{
-		m_keys[key] = action;
-		m_state[action] = false;
+		m_bindings.fill(no_action);
+		m_held_bindings.fill(0);
 	}
 
-	void c_input::add(sf::Mouse::Button button, c_hash action)
+	e_action c_input::add(sf::Keyboard::Key key, c_hash action)
 	{
-		m_mouse_buttons[button] = action;
-		m_state[action] = false;
+		if (key < 0 || key >= sf::Keyboard::KeyCount)
+		{
+			return e_action::none;
+		}
+		e_action const index = bind(static_cast<std::size_t>(key), action);
+		if (m_recorder != nullptr && index != e_action::none)
+		{
+			m_recorder->add(key, action);
+		}
+		return index;
 	}
 
-	bool c_input::operator[](c_hash action) const
+	e_action c_input::add(sf::Mouse::Button button, c_hash action)
 	{
-		auto it = m_state.find(action);
-		if (it != m_state.end())
+		if (button < 0 || button >= sf::Mouse::ButtonCount)
 		{
-			return it->second;
+			return e_action::none;
 		}
-		return false;
+		e_action const index = bind(binding(button), action);
+		if (m_recorder != nullptr && index != e_action::none)
+		{
+			m_recorder->add(button, action);
+		}
+		return index;
 	}
 
 	bool c_input::on(sf::Event const& event)
 	{
-		if (event.type == sf::Event::KeyPressed)
+		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
 		{
-			auto it = m_keys.find(event.key.code);
-			if (it != m_keys.end())
+			auto const key = event.key.code;
+			if (key < 0 || key >= sf::Keyboard::KeyCount || m_bindings[key] == no_action)
 			{
-				m_state[it->second] = true;
-				return true;
+				return false;
 			}
-			return false;
+			set(static_cast<std::size_t>(key), event.type == sf::Event::KeyPressed);
 		}
-		else if (event.type == sf::Event::KeyReleased)
+		else if (event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::MouseButtonReleased)
 		{
-			auto it = m_keys.find(event.key.code);
-			if (it != m_keys.end())
+			auto const button = event.mouseButton.button;
+			if (button < 0 || button >= sf::Mouse::ButtonCount || m_bindings[binding(button)] == no_action)
 			{
-				m_state[it->second] = false;
-				return true;
+				return false;
 			}
+			set(binding(button), event.type == sf::Event::MouseButtonPressed);
+		}
+		else if (event.type == sf::Event::MouseMoved)
+		{
+			m_state.m_mouse = { event.mouseMove.x, event.mouseMove.y };
+		}
+		else
+		{
 			return false;
 		}
-		else if (event.type == sf::Event::MouseButtonPressed)
+
+		if (m_recorder != nullptr)
 		{
-			auto it = m_mouse_buttons.find(event.mouseButton.button);
-			if (it != m_mouse_buttons.end())
+			m_recorder->on(event);
+		}
+		return true;
+	}
+
+	void c_input::reset()
+	{
+		m_held.reset();
+		m_held_bindings.fill(0);
+		m_state.m_current.reset();
+		m_state.m_previous.reset();
+		if (m_recorder != nullptr)
+		{
+			m_recorder->reset();
+		}
+	}
+
+	void c_input::next_frame()
+	{
+		m_state.m_previous = m_state.m_current;
+		++m_state.m_frame;
+		if (m_recorder != nullptr)
+		{
+			m_recorder->next_frame();
+		}
+	}
+
+	void c_input::record(c_input_recorder* recorder)
+	{
+		if (m_recorder != nullptr)
+		{
+			m_recorder->finish();
+		}
+		m_recorder = recorder;
+		if (m_recorder != nullptr)
+		{
+			m_recorder->attach(*this);
+		}
+	}
+
+	e_action c_input::bind(std::size_t binding, c_hash action)
+	{
+		e_action index = m_state.action(action);
+		if (index == e_action::none)
+		{
+			if (!m_state.m_actions.append(action))
 			{
-				m_state[it->second] = true;
-				return true;
+				return e_action::none;
 			}
-			return false;
+			index = static_cast<e_action>(m_state.m_actions.count() - 1);
+		}
+
+		// A held binding keeps holding whichever action it drives.
+		bool const held = m_held[binding];
+		if (held)
+		{
+			set(binding, false);
+		}
+		m_bindings[binding] = static_cast<std::uint8_t>(index);
+		if (held)
+		{
+			set(binding, true);
+		}
+		return index;
+	}
+
+	void c_input::set(std::size_t binding, bool down)
+	{
+		// Key repeat sends more presses for a held key, and keys pressed before reset() still send
+		// their release. Neither changes anything.
+		if (m_held[binding] == down)
+		{
+			return;
 		}
-		else if (event.type == sf::Event::MouseButtonReleased)
+		m_held[binding] = down;
+
+		std::uint8_t const action = m_bindings[binding];
+		if (down)
 		{
-			auto it = m_mouse_buttons.find(event.mouseButton.button);
-			if (it != m_mouse_buttons.end())
+			if (m_held_bindings[action]++ == 0)
 			{
-				m_state[it->second] = false;
-				return true;
+				m_state.m_current[action] = true;
 			}
-			return false;
 		}
-		else if (event.type == sf::Event::MouseMoved)
+		else if (--m_held_bindings[action] == 0)
 		{
-			m_mouse = { event.mouseMove.x, event.mouseMove.y };
-			return true;
+			m_state.m_current[action] = false;
 		}
-		return false;
 	}
 
-	void c_input::reset()
+	void c_input::restore(std::bitset<binding_count> const& held, c_vec2i mouse, std::bitset<max_actions> const& previous)
+	{
+		m_held.reset();
+		m_held_bindings.fill(0);
+		m_state.m_current.reset();
+		for (std::size_t binding = 0; binding < binding_count; ++binding)
+		{
+			if (held[binding] && m_bindings[binding] != no_action)
+			{
+				set(binding, true);
+			}
+		}
+		m_state.m_mouse = mouse;
+		m_state.m_previous = previous;
+		if (m_recorder != nullptr)
+		{
+			m_recorder->state(*this);
+		}
+	}
+
+	e_action c_input_snapshot::action(c_hash name) const
 	{
-		for (auto& [_, state] : m_state)
+		for (std::size_t i = 0; i < m_actions.count(); ++i)
 		{
-			state = false;
+			if (m_actions[i] == name)
+			{
+				return static_cast<e_action>(i);
+			}
 		}
+		return e_action::none;
+	}
+
+	void c_input_publisher::publish()
+	{
+		m_snapshots.write() = m_input.snapshot();
+		m_snapshots.publish();
+		m_input.next_frame();
 	}
 
-	c_vec2i c_input::mouse() const
+	// The triple buffer drops snapshots the reader never saw, and returns the same one again when
+	// nothing new was published, so the writer's edges are replaced with edges against what the
+	// reader last saw. The reader owns its slot, so this is done in place.
+	c_input_snapshot const& c_input_publisher::latest()
 	{
-		return m_mouse;
+		c_input_snapshot& snapshot = m_snapshots.read();
+		snapshot.m_previous = m_seen;
+		m_seen = snapshot.m_current;
+		return snapshot;
 	}
-}
\ No newline at end of file
+}
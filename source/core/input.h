@@ -1,28 +1,141 @@
 #pragma once
 
+#include "core/ds.h"
 #include "core/hash.h"
 #include "core/math.h"
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Window/Mouse.hpp>
-#include <unordered_map>
+#include <array>
+#include <bitset>
+#include <cstdint>
 
 namespace tt
 {
+	class c_input_recorder;
+
+	// Dense index of an action, returned by c_input::add(). Queries by index are a bit test; queries
+	// by c_hash search the bound names first.
+	enum class e_action : std::uint8_t
+	{
+		none = 0xff,
+	};
+
+	// Action and mouse state of one frame. c_input keeps its live state in one of these, and
+	// c_input_publisher hands copies to other threads.
+	class c_input_snapshot
+	{
+	public:
+		static constexpr std::size_t max_actions = 64;
+
+		c_input_snapshot() : m_mouse(0, 0), m_frame(0) {}
+
+		bool operator[](e_action action) const { return action != e_action::none && m_current[index(action)]; }
+		bool pressed_this_frame(e_action action) const { return action != e_action::none && m_current[index(action)] && !m_previous[index(action)]; }
+		bool released_this_frame(e_action action) const { return action != e_action::none && !m_current[index(action)] && m_previous[index(action)]; }
+		bool operator[](c_hash action) const { return (*this)[this->action(action)]; }
+		bool pressed_this_frame(c_hash action) const { return pressed_this_frame(this->action(action)); }
+		bool released_this_frame(c_hash action) const { return released_this_frame(this->action(action)); }
+
+		// e_action::none when nothing is bound to the name.
+		e_action action(c_hash name) const;
+		c_vec2i mouse() const { return m_mouse; }
+		// Number of next_frame() calls before this state.
+		std::uint32_t frame() const { return m_frame; }
+
+	private:
+		friend class c_input;
+		friend class c_input_publisher;
+		friend class c_input_recorder;
+
+		static constexpr std::uint8_t no_action = static_cast<std::uint8_t>(e_action::none);
+
+		static std::size_t index(e_action action) { return static_cast<std::size_t>(action); }
+
+		c_fixed_vector<c_hash, max_actions> m_actions;
+		std::bitset<max_actions> m_current;
+		std::bitset<max_actions> m_previous;
+		c_vec2i m_mouse;
+		std::uint32_t m_frame;
+	};
+
+	// Maps keys and mouse buttons to actions. Every key and button is a binding slot in a flat array
+	// holding the index of its action, so handling an event is a couple of array reads. An action can
+	// have any number of bindings and is held while at least one of them is.
 	class c_input
 	{
 	public:
-		void add(sf::Keyboard::Key key, c_hash action);
-		void add(sf::Mouse::Button button, c_hash action);
-		bool operator[](c_hash action) const;
+		static constexpr std::size_t max_actions = c_input_snapshot::max_actions;
+
+		c_input();
+
+		// A key or button drives one action; binding it again moves it to the new action. Returns the
+		// action's index for per-frame queries, or e_action::none for sf::Keyboard::Unknown or when
+		// there would be more than max_actions actions. Indices stay valid for the c_input's lifetime.
+		e_action add(sf::Keyboard::Key key, c_hash action);
+		e_action add(sf::Mouse::Button button, c_hash action);
+		e_action action(c_hash name) const { return m_state.action(name); }
+		bool operator[](e_action action) const { return m_state[action]; }
+		bool operator[](c_hash action) const { return m_state[action]; }
 		bool on(sf::Event const& event);
 		void reset();
-		c_vec2i mouse() const;
+		c_vec2i mouse() const { return m_state.mouse(); }
+
+		// Call once per frame, after the frame's queries. pressed_this_frame/released_this_frame compare
+		// the current state with the state at the previous next_frame(), so a press and release inside
+		// one frame is not reported.
+		void next_frame();
+		bool pressed_this_frame(e_action action) const { return m_state.pressed_this_frame(action); }
+		bool released_this_frame(e_action action) const { return m_state.released_this_frame(action); }
+		bool pressed_this_frame(c_hash action) const { return m_state.pressed_this_frame(action); }
+		bool released_this_frame(c_hash action) const { return m_state.released_this_frame(action); }
+
+		c_input_snapshot const& snapshot() const { return m_state; }
+
+		// Passes the current state, then every accepted event, reset(), successful add() and
+		// next_frame() call to recorder. Ends the previous recording, if any; nullptr stops recording.
+		void record(c_input_recorder* recorder);
 
 	private:
-		std::unordered_map<sf::Keyboard::Key, c_hash> m_keys;
-		std::unordered_map<sf::Mouse::Button, c_hash> m_mouse_buttons;
-		std::unordered_map<c_hash, bool, s_hash_hasher> m_state;
-		c_vec2i m_mouse;
+		friend class c_input_recorder;
+		friend class c_input_replayer;
+
+		static constexpr std::size_t binding_count = std::size_t{ sf::Keyboard::KeyCount } + std::size_t{ sf::Mouse::ButtonCount };
+		static constexpr std::uint8_t no_action = c_input_snapshot::no_action;
+
+		static std::size_t binding(sf::Mouse::Button button) { return sf::Keyboard::KeyCount + static_cast<std::size_t>(button); }
+		e_action bind(std::size_t binding, c_hash action);
+		void set(std::size_t binding, bool down);
+		// Replaces the live state with a recorded one, keeping the bindings.
+		void restore(std::bitset<binding_count> const& held, c_vec2i mouse, std::bitset<max_actions> const& previous);
+
+		c_input_snapshot m_state;
+		std::array<std::uint8_t, binding_count> m_bindings;
+		std::bitset<binding_count> m_held;
+		std::array<std::uint8_t, max_actions> m_held_bindings;
+		c_input_recorder* m_recorder;
+	};
+
+	// Moves input handling off the simulation thread. SFML only delivers events on the thread that
+	// created the window, so that thread is the writer: it feeds input() and calls publish() once per
+	// frame. One reader thread calls latest() and can share the result with workers for the frame,
+	// with no locks on either side. Edges in a snapshot are relative to the snapshot the reader got
+	// from the previous latest(), so a press is reported once whether the reader keeps up, skips
+	// frames or reads the same frame twice.
+	class c_input_publisher
+	{
+	public:
+		// Writer side.
+		c_input& input() { return m_input; }
+		void publish();
+
+		// Reader side. Stays valid until the next latest() call.
+		c_input_snapshot const& latest();
+
+	private:
+		c_input m_input;
+		c_triple_buffer<c_input_snapshot> m_snapshots;
+		// Reader side: actions held in the last snapshot returned by latest().
+		std::bitset<c_input_snapshot::max_actions> m_seen;
 	};
-}
\ No newline at end of file
+}
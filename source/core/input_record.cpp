@@ -0,0 +1,372 @@
+#include "input_record.h"
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+
+namespace tt
+{
+	namespace
+	{
+		enum class e_input_record : std::uint8_t
+		{
+			key_pressed,
+			key_released,
+			button_pressed,
+			button_released,
+			mouse_moved,
+			reset,
+			key_bound,
+			button_bound,
+			state,
+			end,
+		};
+
+		// Version 2 added the reset and binding records, version 3 the state and end records and the
+		// 4 bit kind. Older streams still replay.
+		constexpr std::uint8_t header[] = { 't', 't', 'i', 3 };
+		constexpr std::uint8_t kind_bits = 4;
+		constexpr std::uint32_t long_delta = 0xff >> kind_bits;
+
+		std::uint32_t zigzag(std::int32_t v)
+		{
+			return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+		}
+
+		std::int32_t unzigzag(std::uint32_t v)
+		{
+			return static_cast<std::int32_t>((v >> 1) ^ (0u - (v & 1)));
+		}
+
+		// Wrapping difference, so any pair of positions round-trips.
+		std::int32_t delta(std::int32_t to, std::int32_t from)
+		{
+			return static_cast<std::int32_t>(static_cast<std::uint32_t>(to) - static_cast<std::uint32_t>(from));
+		}
+
+		std::int32_t apply(std::int32_t from, std::int32_t delta)
+		{
+			return static_cast<std::int32_t>(static_cast<std::uint32_t>(from) + static_cast<std::uint32_t>(delta));
+		}
+	}
+
+	c_input_recorder::c_input_recorder()
+	{
+		clear();
+	}
+
+	void c_input_recorder::attach(c_input const& input)
+	{
+		clear();
+		state(input);
+	}
+
+	void c_input_recorder::state(c_input const& input)
+	{
+		put_header(static_cast<std::uint8_t>(e_input_record::state));
+		std::size_t const keys = sf::Keyboard::KeyCount;
+		for (std::size_t first : { std::size_t{ 0 }, keys })
+		{
+			std::size_t const last = first == 0 ? keys : c_input::binding_count;
+			std::uint32_t held = 0;
+			for (std::size_t binding = first; binding < last; ++binding)
+			{
+				held += input.m_held[binding] ? 1 : 0;
+			}
+			put_varint(held);
+			for (std::size_t binding = first; binding < last; ++binding)
+			{
+				if (input.m_held[binding])
+				{
+					m_data.push_back(static_cast<std::uint8_t>(binding - first));
+				}
+			}
+		}
+		put_mouse(input.mouse());
+		std::uint64_t const previous = input.m_state.m_previous.to_ullong();
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			m_data.push_back(static_cast<std::uint8_t>(previous >> shift));
+		}
+	}
+
+	void c_input_recorder::on(sf::Event const& event)
+	{
+		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
+		{
+			put_header(static_cast<std::uint8_t>(event.type == sf::Event::KeyPressed ? e_input_record::key_pressed : e_input_record::key_released));
+			m_data.push_back(static_cast<std::uint8_t>(event.key.code));
+		}
+		else if (event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::MouseButtonReleased)
+		{
+			put_header(static_cast<std::uint8_t>(event.type == sf::Event::MouseButtonPressed ? e_input_record::button_pressed : e_input_record::button_released));
+			m_data.push_back(static_cast<std::uint8_t>(event.mouseButton.button));
+		}
+		else if (event.type == sf::Event::MouseMoved)
+		{
+			put_header(static_cast<std::uint8_t>(e_input_record::mouse_moved));
+			put_mouse({ event.mouseMove.x, event.mouseMove.y });
+		}
+	}
+
+	void c_input_recorder::reset()
+	{
+		put_header(static_cast<std::uint8_t>(e_input_record::reset));
+	}
+
+	void c_input_recorder::add(sf::Keyboard::Key key, c_hash action)
+	{
+		put_binding(static_cast<std::uint8_t>(e_input_record::key_bound), static_cast<std::uint8_t>(key), action);
+	}
+
+	void c_input_recorder::add(sf::Mouse::Button button, c_hash action)
+	{
+		put_binding(static_cast<std::uint8_t>(e_input_record::button_bound), static_cast<std::uint8_t>(button), action);
+	}
+
+	void c_input_recorder::next_frame()
+	{
+		++m_frame;
+	}
+
+	// The end record sits on the frame after the last one played, so replay stops there.
+	void c_input_recorder::finish()
+	{
+		put_header(static_cast<std::uint8_t>(e_input_record::end));
+	}
+
+	void c_input_recorder::clear()
+	{
+		m_data.assign(std::begin(header), std::end(header));
+		m_frame = 0;
+		m_last_frame = 0;
+		m_mouse = { 0, 0 };
+	}
+
+	void c_input_recorder::put_varint(std::uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			m_data.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		m_data.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	void c_input_recorder::put_header(std::uint8_t kind)
+	{
+		std::uint32_t const frames = m_frame - m_last_frame;
+		m_last_frame = m_frame;
+		if (frames < long_delta)
+		{
+			m_data.push_back(static_cast<std::uint8_t>(kind | (frames << kind_bits)));
+		}
+		else
+		{
+			m_data.push_back(static_cast<std::uint8_t>(kind | (long_delta << kind_bits)));
+			put_varint(frames - long_delta);
+		}
+	}
+
+	void c_input_recorder::put_binding(std::uint8_t kind, std::uint8_t code, c_hash action)
+	{
+		put_header(kind);
+		m_data.push_back(code);
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			m_data.push_back(static_cast<std::uint8_t>(action.m_hash >> shift));
+		}
+	}
+
+	void c_input_recorder::put_mouse(c_vec2i mouse)
+	{
+		put_varint(zigzag(delta(mouse.x(), m_mouse.x())));
+		put_varint(zigzag(delta(mouse.y(), m_mouse.y())));
+		m_mouse = mouse;
+	}
+
+	c_input_replayer::c_input_replayer(std::span<std::uint8_t const> data)
+		: m_read(data.data())
+		, m_end(data.data() + data.size())
+		, m_frame(0)
+		, m_next_frame(0)
+		, m_kind(0)
+		, m_kind_bits(kind_bits)
+		, m_mouse(0, 0)
+		, m_has_next(false)
+	{
+		if (data.size() < sizeof(header) || !std::equal(std::begin(header), std::end(header) - 1, data.begin()) || data[3] < 1 || data[3] > header[3])
+		{
+			return;
+		}
+		m_kind_bits = data[3] < 3 ? 3 : kind_bits;
+		m_read += sizeof(header);
+		m_has_next = read_header();
+	}
+
+	bool c_input_replayer::play_frame(c_input& input)
+	{
+		if (!m_has_next)
+		{
+			return false;
+		}
+		while (m_has_next && m_next_frame == m_frame)
+		{
+			if (m_kind == static_cast<std::uint8_t>(e_input_record::end))
+			{
+				m_has_next = false;
+				return false;
+			}
+			m_has_next = read_record(input) && read_header();
+		}
+		++m_frame;
+		return true;
+	}
+
+	bool c_input_replayer::get_varint(std::uint32_t& value)
+	{
+		value = 0;
+		for (std::uint32_t shift = 0; shift < 35 && m_read != m_end; shift += 7)
+		{
+			std::uint8_t const byte = *m_read++;
+			value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool c_input_replayer::read_header()
+	{
+		if (m_read == m_end)
+		{
+			return false;
+		}
+		std::uint8_t const byte = *m_read++;
+		std::uint32_t const long_frames = 0xff >> m_kind_bits;
+		m_kind = byte & ((1 << m_kind_bits) - 1);
+		std::uint32_t frames = byte >> m_kind_bits;
+		if (frames == long_frames)
+		{
+			std::uint32_t rest;
+			if (!get_varint(rest))
+			{
+				return false;
+			}
+			frames += rest;
+		}
+		m_next_frame += frames;
+		return true;
+	}
+
+	bool c_input_replayer::read_record(c_input& input)
+	{
+		sf::Event event;
+		switch (static_cast<e_input_record>(m_kind))
+		{
+		case e_input_record::reset:
+			input.reset();
+			return true;
+		case e_input_record::state:
+			return read_state(input);
+		case e_input_record::key_bound:
+		case e_input_record::button_bound:
+		{
+			if (m_end - m_read < 5)
+			{
+				return false;
+			}
+			std::uint8_t const code = *m_read++;
+			std::uint32_t action = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				action |= static_cast<std::uint32_t>(*m_read++) << shift;
+			}
+			if (m_kind == static_cast<std::uint8_t>(e_input_record::key_bound))
+			{
+				input.add(static_cast<sf::Keyboard::Key>(code), c_hash(action));
+			}
+			else
+			{
+				input.add(static_cast<sf::Mouse::Button>(code), c_hash(action));
+			}
+			return true;
+		}
+		case e_input_record::key_pressed:
+		case e_input_record::key_released:
+			if (m_read == m_end)
+			{
+				return false;
+			}
+			event.type = m_kind == static_cast<std::uint8_t>(e_input_record::key_pressed) ? sf::Event::KeyPressed : sf::Event::KeyReleased;
+			event.key = {};
+			event.key.code = static_cast<sf::Keyboard::Key>(*m_read++);
+			break;
+		case e_input_record::button_pressed:
+		case e_input_record::button_released:
+			if (m_read == m_end)
+			{
+				return false;
+			}
+			event.type = m_kind == static_cast<std::uint8_t>(e_input_record::button_pressed) ? sf::Event::MouseButtonPressed : sf::Event::MouseButtonReleased;
+			event.mouseButton = {};
+			event.mouseButton.button = static_cast<sf::Mouse::Button>(*m_read++);
+			break;
+		case e_input_record::mouse_moved:
+		{
+			std::uint32_t dx;
+			std::uint32_t dy;
+			if (!get_varint(dx) || !get_varint(dy))
+			{
+				return false;
+			}
+			m_mouse = { apply(m_mouse.x(), unzigzag(dx)), apply(m_mouse.y(), unzigzag(dy)) };
+			event.type = sf::Event::MouseMoved;
+			event.mouseMove = { m_mouse.x(), m_mouse.y() };
+			break;
+		}
+		default:
+			return false;
+		}
+		input.on(event);
+		return true;
+	}
+
+	bool c_input_replayer::read_state(c_input& input)
+	{
+		std::bitset<c_input::binding_count> held;
+		std::size_t const keys = sf::Keyboard::KeyCount;
+		for (std::size_t first : { std::size_t{ 0 }, keys })
+		{
+			std::size_t const count = first == 0 ? keys : c_input::binding_count - keys;
+			std::uint32_t codes;
+			if (!get_varint(codes) || static_cast<std::uint32_t>(m_end - m_read) < codes)
+			{
+				return false;
+			}
+			for (std::uint32_t i = 0; i < codes; ++i)
+			{
+				std::uint8_t const code = *m_read++;
+				if (code < count)
+				{
+					held[first + code] = true;
+				}
+			}
+		}
+		std::uint32_t dx;
+		std::uint32_t dy;
+		if (!get_varint(dx) || !get_varint(dy) || m_end - m_read < 8)
+		{
+			return false;
+		}
+		m_mouse = { apply(m_mouse.x(), unzigzag(dx)), apply(m_mouse.y(), unzigzag(dy)) };
+		std::uint64_t previous = 0;
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			previous |= static_cast<std::uint64_t>(*m_read++) << shift;
+		}
+		input.restore(held, m_mouse, std::bitset<c_input::max_actions>(previous));
+		return true;
+	}
+}
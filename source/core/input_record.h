@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core/input.h"
+#include "core/math.h"
+#include <SFML/Window/Event.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tt
+{
+	// Records the events a c_input accepts, along with its reset() and add() calls, for replay with
+	// c_input_replayer. Attach it with c_input::record(); frames are counted by c_input::next_frame().
+	// Attaching starts a new recording with the held keys and buttons and the mouse position, and
+	// detaching marks its last frame. Bindings made before recording starts are not recorded, so
+	// replay into a c_input bound the same way.
+	//
+	// Stream layout after a 4 byte header: one record per event. The first byte holds the record kind
+	// in its low 4 bits and the number of frames since the previous record in its high 4 bits; 15
+	// means a varint with the remainder follows. Keys and buttons take one more byte, mouse moves
+	// two zigzag varints relative to the previous position, resets and the end nothing, and bindings
+	// the key or button byte followed by the 4 byte little-endian action hash. The attach state is a
+	// varint count and bytes of held keys, the same for buttons, the mouse as a move, and the actions
+	// held on the previous frame as 8 little-endian bytes.
+	class c_input_recorder
+	{
+	public:
+		c_input_recorder();
+
+		// Starts a new recording from input's current state.
+		void attach(c_input const& input);
+		void state(c_input const& input);
+		void on(sf::Event const& event);
+		void reset();
+		void add(sf::Keyboard::Key key, c_hash action);
+		void add(sf::Mouse::Button button, c_hash action);
+		void next_frame();
+		void finish();
+		void clear();
+
+		std::span<std::uint8_t const> data() const { return m_data; }
+		std::uint32_t frame() const { return m_frame; }
+
+	private:
+		void put_varint(std::uint32_t value);
+		void put_header(std::uint8_t kind);
+		void put_binding(std::uint8_t kind, std::uint8_t code, c_hash action);
+		void put_mouse(c_vec2i mouse);
+
+		std::vector<std::uint8_t> m_data;
+		std::uint32_t m_frame;
+		std::uint32_t m_last_frame;
+		c_vec2i m_mouse;
+	};
+
+	// Drives a c_input from a recorded stream, without a window. data must outlive the replayer.
+	//
+	//   while (replayer.play_frame(input)) { update(input); input.next_frame(); }
+	class c_input_replayer
+	{
+	public:
+		explicit c_input_replayer(std::span<std::uint8_t const> data);
+
+		// Feeds input every event, reset and binding recorded for the current frame and moves to the
+		// next frame. Returns false once past the recording's last frame, or past the last record for
+		// streams without an end; a malformed record ends the stream early.
+		bool play_frame(c_input& input);
+		bool done() const { return !m_has_next; }
+		std::uint32_t frame() const { return m_frame; }
+
+	private:
+		bool get_varint(std::uint32_t& value);
+		bool read_header();
+		bool read_record(c_input& input);
+		bool read_state(c_input& input);
+
+		std::uint8_t const* m_read;
+		std::uint8_t const* m_end;
+		std::uint32_t m_frame;
+		std::uint32_t m_next_frame;
+		std::uint8_t m_kind;
+		std::uint8_t m_kind_bits;
+		c_vec2i m_mouse;
+		bool m_has_next;
+	};
+}
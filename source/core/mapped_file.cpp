@@ -0,0 +1,147 @@
+#include "mapped_file.h"
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tt
+{
+	c_mapped_file::c_mapped_file()
+		: m_data(nullptr)
+		, m_size(0)
+		, m_open(false)
+#if defined(_WIN32)
+		, m_file(INVALID_HANDLE_VALUE)
+		, m_mapping(nullptr)
+#endif
+	{
+	}
+
+	c_mapped_file::~c_mapped_file()
+	{
+		close();
+	}
+
+	c_mapped_file::c_mapped_file(c_mapped_file&& other) noexcept
+		: c_mapped_file()
+	{
+		*this = std::move(other);
+	}
+
+	c_mapped_file& c_mapped_file::operator=(c_mapped_file&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+			m_open = std::exchange(other.m_open, false);
+#if defined(_WIN32)
+			m_file = std::exchange(other.m_file, INVALID_HANDLE_VALUE);
+			m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#if defined(_WIN32)
+	bool c_mapped_file::open(char const* path)
+	{
+		close();
+		m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size))
+		{
+			close();
+			return false;
+		}
+		m_open = true;
+		if (size.QuadPart == 0)
+		{
+			return true;
+		}
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_data = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (m_data == nullptr)
+		{
+			close();
+			return false;
+		}
+		m_size = static_cast<std::size_t>(size.QuadPart);
+		return true;
+	}
+
+	void c_mapped_file::close()
+	{
+		if (m_data != nullptr)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping != nullptr)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_file);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+		m_file = INVALID_HANDLE_VALUE;
+		m_mapping = nullptr;
+	}
+#else
+	bool c_mapped_file::open(char const* path)
+	{
+		close();
+		int const fd = ::open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat info;
+		if (fstat(fd, &info) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+		if (info.st_size > 0)
+		{
+			void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				::close(fd);
+				return false;
+			}
+			m_data = data;
+			m_size = static_cast<std::size_t>(info.st_size);
+		}
+		// The mapping keeps the file alive.
+		::close(fd);
+		m_open = true;
+		return true;
+	}
+
+	void c_mapped_file::close()
+	{
+		if (m_data != nullptr)
+		{
+			munmap(const_cast<void*>(m_data), m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace tt
+{
+	// Read-only memory mapping of a whole file.
+	class c_mapped_file
+	{
+	public:
+		c_mapped_file();
+		~c_mapped_file();
+		c_mapped_file(c_mapped_file&& other) noexcept;
+		c_mapped_file& operator=(c_mapped_file&& other) noexcept;
+		c_mapped_file(c_mapped_file const&) = delete;
+		c_mapped_file& operator=(c_mapped_file const&) = delete;
+
+		// Closes any current mapping first. An empty file opens with empty data().
+		bool open(char const* path);
+		void close();
+
+		bool is_open() const { return m_open; }
+		std::span<std::byte const> data() const { return { static_cast<std::byte const*>(m_data), m_size }; }
+
+	private:
+		void const* m_data;
+		std::size_t m_size;
+		bool m_open;
+#if defined(_WIN32)
+		void* m_file;
+		void* m_mapping;
+#endif
+	};
+}
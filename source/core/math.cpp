@@ -1,68 +1,85 @@
 #include "math.h"
+#include <bit>
 #include <cmath>
 #include <corecrt_math_defines.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace tt
 {
-    constexpr std::uint32_t next_prime(std::uint32_t x)
+    void rand_at(std::uint64_t key, std::uint64_t first, std::span<std::uint64_t> out)
     {
-        if (x < 2)
-            return 2;
-
-        if (x == 2)
-            return 3;
-
-        if (x >= 4294960003) // Largest prime number that fits in a uint32_t.
-            return 0;
-
-        uint32_t prime = (x + 1) | 1;
-        while (true)
+        std::size_t i = 0;
+        // An odd first counter is the high half of a block; take it alone so the rest start on a block.
+        if ((first & 1) != 0 && !out.empty())
+        {
+            out[i++] = rand_at(key, first);
+        }
+#if defined(__AVX2__)
+        // Four blocks per iteration, one per 64-bit lane, with each 32-bit Philox word kept in the
+        // low half of its lane so _mm256_mul_epu32 yields the full 64-bit products.
+        __m256i const low = _mm256_set1_epi64x(0xffffffff);
+        __m256i const m0 = _mm256_set1_epi64x(0xd2511f53);
+        __m256i const m1 = _mm256_set1_epi64x(0xcd9e8d57);
+        __m256i const w0 = _mm256_set1_epi64x(0x9e3779b9);
+        __m256i const w1 = _mm256_set1_epi64x(0xbb67ae85);
+        __m256i const key0 = _mm256_set1_epi64x(key & 0xffffffff);
+        __m256i const key1 = _mm256_set1_epi64x(key >> 32);
+        __m256i block = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>((first + i) >> 1)), _mm256_set_epi64x(3, 2, 1, 0));
+        __m256i const four = _mm256_set1_epi64x(4);
+        // Counters wrap at 2^64, so blocks wrap at 2^63.
+        __m256i const block_high = _mm256_set1_epi64x(0x7fffffff);
+        for (; out.size() - i >= 8; i += 8)
         {
-            bool is_prime = true;
-            for (uint32_t divisor = 3; divisor * divisor <= prime; divisor += 2)
+            __m256i c0 = _mm256_and_si256(block, low);
+            __m256i c1 = _mm256_and_si256(_mm256_srli_epi64(block, 32), block_high);
+            __m256i c2 = _mm256_setzero_si256();
+            __m256i c3 = _mm256_setzero_si256();
+            __m256i k0 = key0;
+            __m256i k1 = key1;
+            for (int round = 0; round < 10; ++round)
             {
-                if (prime % divisor == 0)
+                if (round > 0)
                 {
-                    is_prime = false;
-                    break;
+                    k0 = _mm256_add_epi32(k0, w0);
+                    k1 = _mm256_add_epi32(k1, w1);
                 }
+                __m256i const p0 = _mm256_mul_epu32(c0, m0);
+                __m256i const p1 = _mm256_mul_epu32(c2, m1);
+                c0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1), k0);
+                c1 = _mm256_and_si256(p1, low);
+                c2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3), k1);
+                c3 = _mm256_and_si256(p0, low);
             }
-
-            if (is_prime)
-                return prime;
-
-            prime += 2;
+            // Interleave the low and high halves of the four blocks back into counter order.
+            __m256i const lo = _mm256_or_si256(_mm256_slli_epi64(c1, 32), c0);
+            __m256i const hi = _mm256_or_si256(_mm256_slli_epi64(c3, 32), c2);
+            __m256i const even = _mm256_unpacklo_epi64(lo, hi);
+            __m256i const odd = _mm256_unpackhi_epi64(lo, hi);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + i), _mm256_permute2x128_si256(even, odd, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + i + 4), _mm256_permute2x128_si256(even, odd, 0x31));
+            block = _mm256_add_epi64(block, four);
+        }
+#endif
+        for (; out.size() - i >= 2; i += 2)
+        {
+            std::uint64_t const block = (first + i) >> 1;
+            std::array<std::uint32_t, 4> const words = philox4x32(
+                { static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32), 0, 0 },
+                { static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32) });
+            out[i] = (static_cast<std::uint64_t>(words[1]) << 32) | words[0];
+            out[i + 1] = (static_cast<std::uint64_t>(words[3]) << 32) | words[2];
+        }
+        if (i < out.size())
+        {
+            out[i] = rand_at(key, first + i);
         }
     }
 
     c_rand::c_rand() : m_engine(m_device()) {}
 
-    constexpr c_angle c_angle::from_rad(long double angle_rad)
-    {
-        return static_cast<std::int16_t>(angle_rad * static_cast<long double>(deg_180) / M_PI);
-    }
-
-    constexpr c_angle c_angle::from_deg(long double angle_deg)
-    {
-        return static_cast<std::int16_t>(angle_deg * static_cast<long double>(deg_45) / 45.0L);
-    }
-
-    constexpr c_angle::c_angle() : m_angle(0) {}
-    constexpr c_angle::c_angle(std::int16_t angle) : m_angle(angle) {}
-
-    constexpr std::int16_t c_angle::angle() const { return m_angle; }
-    constexpr std::int16_t& c_angle::angle() { return m_angle; }
-
-    constexpr long double c_angle::angle_rad() const
-    {
-        return static_cast<long double>(m_angle) * M_PI / static_cast<long double>(deg_180);
-    }
-
-    constexpr long double c_angle::angle_deg() const
-    {
-        return static_cast<long double>(m_angle) / static_cast<long double>(deg_45) * 45.0L;
-    }
-
     void c_angle::set_rad(float angle_rad)
     {
         m_angle = static_cast<std::int16_t>(angle_rad * static_cast<float>(deg_180) / M_PI);
@@ -73,12 +90,6 @@ namespace tt
         m_angle = static_cast<std::int16_t>(angle_deg * static_cast<float>(deg_45) / 45.0f);
     }
 
-    constexpr bool c_angle::operator==(c_angle const& other) const { return m_angle == other.m_angle; }
-    constexpr bool c_angle::operator!=(c_angle const& other) const { return m_angle != other.m_angle; }
-    constexpr c_angle c_angle::operator+(c_angle const& other) const { return c_angle(m_angle + other.m_angle); }
-    constexpr c_angle c_angle::operator-(c_angle const& other) const { return c_angle(m_angle - other.m_angle); }
-    constexpr c_angle c_angle::operator-() const { return c_angle(-m_angle); }
-
     c_angle& c_angle::operator+=(c_angle const& other)
     {
         m_angle += other.m_angle;
@@ -111,29 +122,87 @@ namespace tt
         return { static_cast<int32_t>(cos_val * x - sin_val * y), static_cast<int32_t>(sin_val * x + cos_val * y) };
     }
 
-    bool overlaps(c_vec2i a_center, c_vec2i a_extents, c_vec2i b_center, c_vec2i b_extents)
+    namespace
     {
-        return std::abs(a_center.x() - b_center.x()) < a_extents.x() / 2 + b_extents.x() / 2
-            && std::abs(a_center.y() - b_center.y()) < a_extents.y() / 2 + b_extents.y() / 2;
-    }
+        // sin over one turn in 1024 steps, plus the wrap-around entry for interpolation. Built by
+        // repeated rotation so only one gcem sin/cos pair is evaluated at compile time.
+        constexpr int sin_table_bits = 10;
+        constexpr auto sin_table = [] {
+            std::array<float, (1 << sin_table_bits) + 1> table{};
+            double const step = 2.0 * std::numbers::pi / (1 << sin_table_bits);
+            double const step_cos = gcem::cos(step);
+            double const step_sin = gcem::sin(step);
+            double x = 1.0;
+            double y = 0.0;
+            for (std::size_t i = 0; i < table.size(); ++i)
+            {
+                table[i] = static_cast<float>(y);
+                double const next_x = x * step_cos - y * step_sin;
+                y = y * step_cos + x * step_sin;
+                x = next_x;
+            }
+            return table;
+        }();
 
-    constexpr c_angle operator "" _deg(long double degrees)
-    {
-        return c_angle::from_deg(degrees);
+        float table_sin(std::uint16_t angle)
+        {
+            constexpr int shift = 16 - sin_table_bits;
+            std::uint32_t const i = angle >> shift;
+            float const t = static_cast<float>(angle & ((1u << shift) - 1)) * (1.0f / (1 << shift));
+            return sin_table[i] + (sin_table[i + 1] - sin_table[i]) * t;
+        }
     }
 
-    constexpr c_angle operator "" _deg(unsigned long long degrees)
+    c_vec2f c_angle::dir() const
     {
-        return c_angle::from_deg(static_cast<long double>(degrees));
+        std::uint16_t const angle = static_cast<std::uint16_t>(m_angle);
+        return { table_sin(static_cast<std::uint16_t>(angle + deg_90)), table_sin(angle) };
     }
 
-    constexpr c_angle operator "" _rad(long double radians)
+    bool overlaps(c_vec2i a_center, c_vec2i a_extents, c_vec2i b_center, c_vec2i b_extents)
     {
-        return c_angle::from_rad(radians);
+        return std::abs(a_center.x() - b_center.x()) < a_extents.x() / 2 + b_extents.x() / 2
+            && std::abs(a_center.y() - b_center.y()) < a_extents.y() / 2 + b_extents.y() / 2;
     }
 
-    constexpr c_angle operator "" _rad(unsigned long long radians)
+    static_assert(sizeof(c_vec2i) == 2 * sizeof(std::int32_t), "Batch overlaps reads c_vec2i arrays as interleaved x, y pairs");
+
+    std::size_t overlaps(c_vec2i center, c_vec2i extents, std::span<c_vec2i const> centers, std::span<c_vec2i const> extents_list, std::uint32_t* out)
     {
-        return c_angle::from_rad(static_cast<long double>(radians));
+        std::size_t const count = centers.size() < extents_list.size() ? centers.size() : extents_list.size();
+        std::size_t written = 0;
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        // Four boxes per iteration as x, y lanes. Halving rounds toward zero like the scalar extents / 2.
+        auto const half = [](__m256i v) { return _mm256_srai_epi32(_mm256_add_epi32(v, _mm256_srli_epi32(v, 31)), 1); };
+        __m256i const a_center = _mm256_set_epi32(center.y(), center.x(), center.y(), center.x(), center.y(), center.x(), center.y(), center.x());
+        __m256i const a_half = half(_mm256_set_epi32(extents.y(), extents.x(), extents.y(), extents.x(), extents.y(), extents.x(), extents.y(), extents.x()));
+        std::int32_t const* c = reinterpret_cast<std::int32_t const*>(centers.data());
+        std::int32_t const* e = reinterpret_cast<std::int32_t const*>(extents_list.data());
+        for (; count - i >= 4; i += 4)
+        {
+            __m256i const b_center = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(c + 2 * i));
+            __m256i const b_half = half(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(e + 2 * i)));
+            __m256i const distance = _mm256_abs_epi32(_mm256_sub_epi32(a_center, b_center));
+            __m256i const axis = _mm256_cmpgt_epi32(_mm256_add_epi32(a_half, b_half), distance);
+            // A box overlaps when both its x and y lanes pass.
+            __m256i const both = _mm256_and_si256(axis, _mm256_shuffle_epi32(axis, 0xb1));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(both)) & 0x55;
+            while (mask != 0)
+            {
+                int const lane = std::countr_zero(static_cast<unsigned>(mask));
+                out[written++] = static_cast<std::uint32_t>(i + lane / 2);
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            if (overlaps(center, extents, centers[i], extents_list[i]))
+            {
+                out[written++] = static_cast<std::uint32_t>(i);
+            }
+        }
+        return written;
     }
 }
\ No newline at end of file
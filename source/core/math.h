@@ -1,27 +1,338 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <random>
 #include <gcem.hpp>
 #include <limits>
+#include <numbers>
+#include <span>
+#include <type_traits>
 
 namespace tt
 {
-    // Returns the next prime number after x. Returns 0 if there is no prime number after uX that fits in a uint32_t.
-    constexpr std::uint32_t next_prime(std::uint32_t x);
+    // Returns the high 64 bits of the 128-bit product a * b.
+    constexpr std::uint64_t mul_hi(std::uint64_t a, std::uint64_t b)
+    {
+        std::uint64_t const a_lo = a & 0xffffffff;
+        std::uint64_t const a_hi = a >> 32;
+        std::uint64_t const b_lo = b & 0xffffffff;
+        std::uint64_t const b_hi = b >> 32;
+        std::uint64_t const lo_lo = a_lo * b_lo;
+        std::uint64_t const lo_hi = a_lo * b_hi;
+        std::uint64_t const hi_lo = a_hi * b_lo;
+        std::uint64_t const mid = (lo_lo >> 32) + (lo_hi & 0xffffffff) + (hi_lo & 0xffffffff);
+        return a_hi * b_hi + (lo_hi >> 32) + (hi_lo >> 32) + (mid >> 32);
+    }
+
+    // (base ^ exp) % mod for 32-bit values.
+    constexpr std::uint32_t pow_mod(std::uint32_t base, std::uint32_t exp, std::uint32_t mod)
+    {
+        std::uint64_t result = 1;
+        std::uint64_t b = base % mod;
+        while (exp > 0)
+        {
+            if (exp & 1)
+            {
+                result = result * b % mod;
+            }
+            b = b * b % mod;
+            exp >>= 1;
+        }
+        return static_cast<std::uint32_t>(result);
+    }
+
+    // Montgomery arithmetic modulo an odd 64-bit n, so 64-bit modular products need no 128-bit division.
+    class c_montgomery
+    {
+    public:
+        constexpr c_montgomery(std::uint64_t n) : m_n(n), m_inv(n), m_one((0 - n) % n), m_r2(m_one)
+        {
+            // Newton iteration doubles the correct low bits of n^-1 mod 2^64 each step, starting from 3.
+            for (int i = 0; i < 5; ++i)
+            {
+                m_inv *= 2 - n * m_inv;
+            }
+            for (int i = 0; i < 64; ++i)
+            {
+                m_r2 = m_r2 >= n - m_r2 ? m_r2 - (n - m_r2) : m_r2 + m_r2;
+            }
+        }
+
+        constexpr std::uint64_t one() const { return m_one; }
+        constexpr std::uint64_t minus_one() const { return m_n - m_one; }
+        constexpr std::uint64_t to(std::uint64_t a) const { return mul(a % m_n, m_r2); }
+
+        constexpr std::uint64_t mul(std::uint64_t a, std::uint64_t b) const
+        {
+            std::uint64_t const lo = a * b;
+            std::uint64_t const hi = mul_hi(a, b);
+            std::uint64_t const m = mul_hi(lo * m_inv, m_n);
+            return hi >= m ? hi - m : hi - m + m_n;
+        }
+
+        constexpr std::uint64_t pow(std::uint64_t base, std::uint64_t exp) const
+        {
+            std::uint64_t result = m_one;
+            while (exp > 0)
+            {
+                if (exp & 1)
+                {
+                    result = mul(result, base);
+                }
+                base = mul(base, base);
+                exp >>= 1;
+            }
+            return result;
+        }
+
+    private:
+        std::uint64_t m_n;
+        std::uint64_t m_inv;
+        std::uint64_t m_one;
+        std::uint64_t m_r2;
+    };
+
+    // Deterministic Miller-Rabin. Bases {2, 7, 61} cover every 32-bit value.
+    constexpr bool is_prime(std::uint32_t n)
+    {
+        constexpr std::uint32_t small_primes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+        if (n < 2)
+        {
+            return false;
+        }
+        for (std::uint32_t p : small_primes)
+        {
+            if (n % p == 0)
+            {
+                return n == p;
+            }
+        }
+        if (n < 37 * 37)
+        {
+            return true;
+        }
+        std::uint32_t d = n - 1;
+        int s = 0;
+        while ((d & 1) == 0)
+        {
+            d >>= 1;
+            ++s;
+        }
+        for (std::uint32_t a : { 2u, 7u, 61u })
+        {
+            std::uint64_t x = pow_mod(a, d, n);
+            if (x == 1 || x == n - 1)
+            {
+                continue;
+            }
+            bool composite = true;
+            for (int i = 1; i < s && composite; ++i)
+            {
+                x = x * x % n;
+                composite = x != n - 1;
+            }
+            if (composite)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Deterministic Miller-Rabin with the seven bases found by Jim Sinclair, which cover every 64-bit value.
+    constexpr bool is_prime64(std::uint64_t n)
+    {
+        if (n <= std::numeric_limits<std::uint32_t>::max())
+        {
+            return is_prime(static_cast<std::uint32_t>(n));
+        }
+        for (std::uint64_t p : { 2ull, 3ull, 5ull, 7ull, 11ull, 13ull, 17ull, 19ull, 23ull, 29ull, 31ull, 37ull })
+        {
+            if (n % p == 0)
+            {
+                return false;
+            }
+        }
+        c_montgomery const mont(n);
+        std::uint64_t d = n - 1;
+        int s = 0;
+        while ((d & 1) == 0)
+        {
+            d >>= 1;
+            ++s;
+        }
+        for (std::uint64_t a : { 2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull })
+        {
+            if (a % n == 0)
+            {
+                continue;
+            }
+            std::uint64_t x = mont.pow(mont.to(a), d);
+            if (x == mont.one() || x == mont.minus_one())
+            {
+                continue;
+            }
+            bool composite = true;
+            for (int i = 1; i < s && composite; ++i)
+            {
+                x = mont.mul(x, x);
+                composite = x != mont.minus_one();
+            }
+            if (composite)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 
-    // constexpr and deterministic random number generator.
+    // Returns the next prime number after x. Returns 0 if there is no prime number after x that fits in a uint32_t.
+    constexpr std::uint32_t next_prime(std::uint32_t x)
+    {
+        if (x < 2)
+        {
+            return 2;
+        }
+        if (x >= 4294967291u) // Largest prime number that fits in a uint32_t.
+        {
+            return 0;
+        }
+        std::uint32_t prime = (x + 1) | 1;
+        while (!is_prime(prime))
+        {
+            prime += 2;
+        }
+        return prime;
+    }
+
+    // Returns the next prime number after x. Returns 0 if there is no prime number after x that fits in a uint64_t.
+    constexpr std::uint64_t next_prime64(std::uint64_t x)
+    {
+        if (x < 2)
+        {
+            return 2;
+        }
+        if (x >= 18446744073709551557ull) // Largest prime number that fits in a uint64_t.
+        {
+            return 0;
+        }
+        std::uint64_t prime = (x + 1) | 1;
+        while (!is_prime64(prime))
+        {
+            prime += 2;
+        }
+        return prime;
+    }
+
+    // Hash table capacities: each entry is the first prime after twice the previous one.
+    constexpr std::array<std::uint32_t, 30> make_prime_capacities()
+    {
+        std::array<std::uint32_t, 30> table = {};
+        table[0] = 5;
+        for (std::size_t i = 1; i < table.size(); ++i)
+        {
+            table[i] = next_prime(table[i - 1] * 2);
+        }
+        return table;
+    }
+
+    constexpr std::array<std::uint32_t, 30> prime_capacities = make_prime_capacities();
+
+    // Returns the smallest capacity from prime_capacities that is at least count, or 0 if count is too large.
+    constexpr std::uint32_t prime_capacity(std::uint32_t count)
+    {
+        for (std::uint32_t capacity : prime_capacities)
+        {
+            if (capacity >= count)
+            {
+                return capacity;
+            }
+        }
+        return 0;
+    }
+
+    static_assert(next_prime(13) == 17);
+    static_assert(next_prime(4294967290u) == 4294967291u);
+    static_assert(next_prime(4294967291u) == 0);
+    static_assert(!is_prime(3215031751u)); // Strong pseudoprime to bases 2, 3, 5 and 7.
+    static_assert(is_prime64(18446744073709551557ull));
+    static_assert(!is_prime64(3825123056546413051ull)); // Strong pseudoprime to the first nine prime bases.
+    static_assert(prime_capacities.back() != 0);
+
+    // Advances state and returns the next splitmix64 output. Used to expand a single seed into
+    // engine state, and as a cheap 64-bit mixer.
+    constexpr std::uint64_t splitmix64(std::uint64_t& state)
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    // Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+    // Maps a 128-bit counter and a 64-bit key to 128 random bits with no state.
+    constexpr std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key)
+    {
+        constexpr std::uint32_t m0 = 0xd2511f53;
+        constexpr std::uint32_t m1 = 0xcd9e8d57;
+        constexpr std::uint32_t w0 = 0x9e3779b9;
+        constexpr std::uint32_t w1 = 0xbb67ae85;
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += w0;
+                key[1] += w1;
+            }
+            std::uint64_t const p0 = static_cast<std::uint64_t>(m0) * ctr[0];
+            std::uint64_t const p1 = static_cast<std::uint64_t>(m1) * ctr[2];
+            ctr = {
+                static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                static_cast<std::uint32_t>(p1),
+                static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                static_cast<std::uint32_t>(p0),
+            };
+        }
+        return ctr;
+    }
+
+    // Stateless random value for (key, counter). Every pair is independent, so parallel jobs can
+    // draw e.g. rand_at(seed, (frame << 32) | entity) without sharing state. Same result at compile
+    // time and run time. Each Philox block gives two results: block i holds counters 2i (low 64 bits)
+    // and 2i + 1 (high 64 bits).
+    constexpr std::uint64_t rand_at(std::uint64_t key, std::uint64_t counter)
+    {
+        std::uint64_t const block = counter >> 1;
+        std::array<std::uint32_t, 4> const out = philox4x32(
+            { static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32), 0, 0 },
+            { static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32) });
+        std::size_t const half = (counter & 1) * 2;
+        return (static_cast<std::uint64_t>(out[half + 1]) << 32) | out[half];
+    }
+
+    // Fills out[i] with rand_at(key, first + i), one Philox block per two values. Uses AVX2 when the
+    // library is built with it.
+    void rand_at(std::uint64_t key, std::uint64_t first, std::span<std::uint64_t> out);
+
+    // constexpr and deterministic random number generator. Returns a value in [0, max) for seed.
     template<class T>
     constexpr T det_rand_int(T seed, T max = std::numeric_limits<T>::max())
     {
         static_assert(std::is_integral_v<T>, "T must be an integral type");
-        if (max == 0)
+        if (max < 1)
         {
             return 0;
         }
-        return (seed * 1664525 + 1013904223) % max;
+        using u_t = std::make_unsigned_t<T>;
+        std::uint64_t const bits = rand_at(0, static_cast<u_t>(seed));
+        return static_cast<T>(mul_hi(bits, static_cast<std::uint64_t>(max)));
     }
 
+    // Known answer from the Random123 distribution.
+    static_assert(philox4x32({ 0, 0, 0, 0 }, { 0, 0 }) == std::array<std::uint32_t, 4>{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 });
+    static_assert(rand_at(0, 0) == 0xe169c58d6627e8d5 && rand_at(0, 1) == 0x9b00dbd8bc57ac4c);
+
     // Uses the device to generate a non-deterministic random number
     class c_rand
     {
@@ -196,6 +507,9 @@ namespace tt
 
         [[nodiscard]] c_vec2f rot(c_vec2f const vec) const;
         [[nodiscard]] c_vec2i rot(c_vec2i const vec) const;
+        // (cos, sin) from a table with linear interpolation, accurate to about 5e-6. Much cheaper than rot()
+        // when the same angle is applied to several points.
+        [[nodiscard]] c_vec2f dir() const;
 
     private:
         std::int16_t m_angle;
@@ -203,6 +517,11 @@ namespace tt
 
     bool overlaps(c_vec2i a_center, c_vec2i a_extents, c_vec2i b_center, c_vec2i b_extents);
 
+    // Tests one box against many with the same rule as overlaps() and writes the indices of the overlapping boxes
+    // to out, which must have room for centers.size() entries. Returns the number written. Uses AVX2 when the
+    // library is built with it.
+    std::size_t overlaps(c_vec2i center, c_vec2i extents, std::span<c_vec2i const> centers, std::span<c_vec2i const> extents_list, std::uint32_t* out);
+
     constexpr c_angle operator "" _deg(long double degrees);
     constexpr c_angle operator "" _deg(unsigned long long degrees);
     constexpr c_angle operator "" _rad(long double radians);
@@ -220,4 +539,64 @@ namespace tt
         nw,
         count
     };
+
+    // Unit step for a direction, with y growing downward (south) as in screen coordinates.
+    constexpr c_vec2i direction_offset(e_compass_direction dir)
+    {
+        constexpr c_vec2i offsets[] = { { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 } };
+        return dir < e_compass_direction::count ? offsets[static_cast<std::uint8_t>(dir)] : c_vec2i();
+    }
+
+    // c_angle inline implementations (needs to be in header for constexpr)
+    constexpr c_angle c_angle::from_rad(long double angle_rad)
+    {
+        return static_cast<std::int16_t>(angle_rad * static_cast<long double>(deg_180) / std::numbers::pi_v<long double>);
+    }
+
+    constexpr c_angle c_angle::from_deg(long double angle_deg)
+    {
+        return static_cast<std::int16_t>(angle_deg * static_cast<long double>(deg_45) / 45.0L);
+    }
+
+    constexpr c_angle::c_angle() : m_angle(0) {}
+    constexpr c_angle::c_angle(std::int16_t angle) : m_angle(angle) {}
+
+    constexpr std::int16_t c_angle::angle() const { return m_angle; }
+    constexpr std::int16_t& c_angle::angle() { return m_angle; }
+
+    constexpr long double c_angle::angle_rad() const
+    {
+        return static_cast<long double>(m_angle) * std::numbers::pi_v<long double> / static_cast<long double>(deg_180);
+    }
+
+    constexpr long double c_angle::angle_deg() const
+    {
+        return static_cast<long double>(m_angle) / static_cast<long double>(deg_45) * 45.0L;
+    }
+
+    constexpr bool c_angle::operator==(c_angle const& other) const { return m_angle == other.m_angle; }
+    constexpr bool c_angle::operator!=(c_angle const& other) const { return m_angle != other.m_angle; }
+    constexpr c_angle c_angle::operator+(c_angle const& other) const { return c_angle(m_angle + other.m_angle); }
+    constexpr c_angle c_angle::operator-(c_angle const& other) const { return c_angle(m_angle - other.m_angle); }
+    constexpr c_angle c_angle::operator-() const { return c_angle(-m_angle); }
+
+    constexpr c_angle operator "" _deg(long double degrees)
+    {
+        return c_angle::from_deg(degrees);
+    }
+
+    constexpr c_angle operator "" _deg(unsigned long long degrees)
+    {
+        return c_angle::from_deg(static_cast<long double>(degrees));
+    }
+
+    constexpr c_angle operator "" _rad(long double radians)
+    {
+        return c_angle::from_rad(radians);
+    }
+
+    constexpr c_angle operator "" _rad(unsigned long long radians)
+    {
+        return c_angle::from_rad(static_cast<long double>(radians));
+    }
 }
\ No newline at end of file
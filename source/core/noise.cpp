@@ -0,0 +1,494 @@
+#include "noise.h"
+#include "core/math.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// The scalar and AVX2 paths run the same kernels (templates over the lane type below) with the same
+// sequence of IEEE operations, which is what makes them bit-identical. Fusing a * b + c into an FMA
+// would break that, so the build turns floating-point contraction off for this file.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace tt
+{
+	namespace
+	{
+		constexpr std::uint32_t max_octaves = 16;
+
+		// Scalar lanes: float, std::uint32_t and bool.
+		float floor_lane(float v) { return std::floor(v); }
+		std::uint32_t to_int(float v) { return static_cast<std::uint32_t>(static_cast<std::int32_t>(v)); }
+		float to_float(std::uint32_t v) { return static_cast<float>(static_cast<std::int32_t>(v)); }
+		float select(bool mask, float a, float b) { return mask ? a : b; }
+		bool less(float a, float b) { return a < b; }
+		bool greater(float a, float b) { return a > b; }
+		bool greater_equal(float a, float b) { return a >= b; }
+		bool has_bits(std::uint32_t v, std::uint32_t bits) { return (v & bits) != 0; }
+		bool less(std::uint32_t a, std::uint32_t b) { return a < b; }
+		bool equal(std::uint32_t a, std::uint32_t b) { return a == b; }
+		bool mask_and(bool a, bool b) { return a && b; }
+		bool mask_or(bool a, bool b) { return a || b; }
+		bool mask_not(bool a) { return !a; }
+		template<int N> std::uint32_t shr(std::uint32_t v) { return v >> N; }
+
+#if defined(__AVX2__)
+		// AVX2 lanes: 8 floats, 8 uint32s and a float compare mask.
+		struct s_f8 { __m256 v; };
+		struct s_i8 { __m256i v; };
+		struct s_m8 { __m256 v; };
+
+		s_f8 operator+(s_f8 a, s_f8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+		s_f8 operator-(s_f8 a, s_f8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		s_f8 operator*(s_f8 a, s_f8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		s_i8 operator+(s_i8 a, s_i8 b) { return { _mm256_add_epi32(a.v, b.v) }; }
+		s_i8 operator*(s_i8 a, s_i8 b) { return { _mm256_mullo_epi32(a.v, b.v) }; }
+		s_i8 operator^(s_i8 a, s_i8 b) { return { _mm256_xor_si256(a.v, b.v) }; }
+		s_i8 operator&(s_i8 a, s_i8 b) { return { _mm256_and_si256(a.v, b.v) }; }
+
+		s_f8 floor_lane(s_f8 v) { return { _mm256_floor_ps(v.v) }; }
+		s_i8 to_int(s_f8 v) { return { _mm256_cvttps_epi32(v.v) }; }
+		s_f8 to_float(s_i8 v) { return { _mm256_cvtepi32_ps(v.v) }; }
+		s_f8 select(s_m8 mask, s_f8 a, s_f8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+		s_m8 less(s_f8 a, s_f8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		s_m8 greater(s_f8 a, s_f8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+		s_m8 greater_equal(s_f8 a, s_f8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+		s_m8 has_bits(s_i8 v, std::uint32_t bits)
+		{
+			__m256i const b = _mm256_set1_epi32(static_cast<int>(bits));
+			return { _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(v.v, b), b)) };
+		}
+		s_m8 less(s_i8 a, s_i8 b) { return { _mm256_castsi256_ps(_mm256_cmpgt_epi32(b.v, a.v)) }; }
+		s_m8 equal(s_i8 a, s_i8 b) { return { _mm256_castsi256_ps(_mm256_cmpeq_epi32(a.v, b.v)) }; }
+		s_m8 mask_and(s_m8 a, s_m8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+		s_m8 mask_or(s_m8 a, s_m8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+		s_m8 mask_not(s_m8 a) { return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+		template<int N> s_i8 shr(s_i8 v) { return { _mm256_srli_epi32(v.v, N) }; }
+#endif
+
+		template<class F>
+		F fsplat(float v)
+		{
+#if defined(__AVX2__)
+			if constexpr (std::is_same_v<F, s_f8>)
+			{
+				return { _mm256_set1_ps(v) };
+			}
+			else
+#endif
+			{
+				return v;
+			}
+		}
+
+		template<class I>
+		I isplat(std::uint32_t v)
+		{
+#if defined(__AVX2__)
+			if constexpr (std::is_same_v<I, s_i8>)
+			{
+				return { _mm256_set1_epi32(static_cast<int>(v)) };
+			}
+			else
+#endif
+			{
+				return v;
+			}
+		}
+
+		template<class F>
+		struct s_int_lane
+		{
+			using type = std::uint32_t;
+		};
+
+#if defined(__AVX2__)
+		template<>
+		struct s_int_lane<s_f8>
+		{
+			using type = s_i8;
+		};
+#endif
+
+		// Lattice hash: coordinates folded in with large odd constants, then Wellons' lowbias32 finalizer.
+		template<class I>
+		I hash(I seed, I x, I y, I z)
+		{
+			I h = seed ^ (x * isplat<I>(0x9e3779b1)) ^ (y * isplat<I>(0x85ebca77)) ^ (z * isplat<I>(0xc2b2ae3d));
+			h = h ^ shr<16>(h);
+			h = h * isplat<I>(0x7feb352d);
+			h = h ^ shr<15>(h);
+			h = h * isplat<I>(0x846ca68b);
+			return h ^ shr<16>(h);
+		}
+
+		template<class F>
+		F fade(F t)
+		{
+			return t * t * t * (t * (t * fsplat<F>(6.0f) - fsplat<F>(15.0f)) + fsplat<F>(10.0f));
+		}
+
+		template<class F>
+		F lerp(F a, F b, F t)
+		{
+			return a + t * (b - a);
+		}
+
+		// Hash to [-1, 1).
+		template<class F, class I>
+		F unit(I h)
+		{
+			return to_float(shr<8>(h)) * fsplat<F>(0x1.0p-23f) - fsplat<F>(1.0f);
+		}
+
+		// Dot product with one of the 8 gradients (+-1, +-2) / (+-2, +-1).
+		template<class F, class I>
+		F grad2(I h, F x, F y)
+		{
+			F const zero = fsplat<F>(0.0f);
+			auto const swap = has_bits(h, 4);
+			F u = select(swap, y, x);
+			F v = select(swap, x, y);
+			u = select(has_bits(h, 1), zero - u, u);
+			v = select(has_bits(h, 2), zero - v, v);
+			return u + v + v;
+		}
+
+		// Dot product with one of Perlin's 12 cube-edge gradients (16 entries, 4 repeated).
+		template<class F, class I>
+		F grad3(I h, F x, F y, F z)
+		{
+			F const zero = fsplat<F>(0.0f);
+			I const low = h & isplat<I>(15);
+			F const u = select(less(low, isplat<I>(8)), x, y);
+			F const v = select(less(low, isplat<I>(4)), y, select(mask_or(equal(low, isplat<I>(12)), equal(low, isplat<I>(14))), x, z));
+			return select(has_bits(h, 1), zero - u, u) + select(has_bits(h, 2), zero - v, v);
+		}
+
+		template<class F, class I>
+		F value2(I seed, F x, F y)
+		{
+			F const xf = floor_lane(x);
+			F const yf = floor_lane(y);
+			I const xi = to_int(xf);
+			I const yi = to_int(yf);
+			I const one = isplat<I>(1);
+			I const zero = isplat<I>(0);
+			F const u = fade(x - xf);
+			F const v = fade(y - yf);
+			F const a = lerp(unit<F>(hash(seed, xi, yi, zero)), unit<F>(hash(seed, xi + one, yi, zero)), u);
+			F const b = lerp(unit<F>(hash(seed, xi, yi + one, zero)), unit<F>(hash(seed, xi + one, yi + one, zero)), u);
+			return lerp(a, b, v);
+		}
+
+		template<class F, class I>
+		F value3(I seed, F x, F y, F z)
+		{
+			F const xf = floor_lane(x);
+			F const yf = floor_lane(y);
+			F const zf = floor_lane(z);
+			I const xi = to_int(xf);
+			I const yi = to_int(yf);
+			I const zi = to_int(zf);
+			I const one = isplat<I>(1);
+			F const u = fade(x - xf);
+			F const v = fade(y - yf);
+			F const w = fade(z - zf);
+			F const a0 = lerp(unit<F>(hash(seed, xi, yi, zi)), unit<F>(hash(seed, xi + one, yi, zi)), u);
+			F const b0 = lerp(unit<F>(hash(seed, xi, yi + one, zi)), unit<F>(hash(seed, xi + one, yi + one, zi)), u);
+			F const a1 = lerp(unit<F>(hash(seed, xi, yi, zi + one)), unit<F>(hash(seed, xi + one, yi, zi + one)), u);
+			F const b1 = lerp(unit<F>(hash(seed, xi, yi + one, zi + one)), unit<F>(hash(seed, xi + one, yi + one, zi + one)), u);
+			return lerp(lerp(a0, b0, v), lerp(a1, b1, v), w);
+		}
+
+		template<class F, class I>
+		F perlin2(I seed, F x, F y)
+		{
+			F const xf = floor_lane(x);
+			F const yf = floor_lane(y);
+			I const xi = to_int(xf);
+			I const yi = to_int(yf);
+			I const one = isplat<I>(1);
+			I const zero = isplat<I>(0);
+			F const fx = x - xf;
+			F const fy = y - yf;
+			F const fx1 = fx - fsplat<F>(1.0f);
+			F const fy1 = fy - fsplat<F>(1.0f);
+			F const u = fade(fx);
+			F const v = fade(fy);
+			F const a = lerp(grad2(hash(seed, xi, yi, zero), fx, fy), grad2(hash(seed, xi + one, yi, zero), fx1, fy), u);
+			F const b = lerp(grad2(hash(seed, xi, yi + one, zero), fx, fy1), grad2(hash(seed, xi + one, yi + one, zero), fx1, fy1), u);
+			return lerp(a, b, v) * fsplat<F>(0.5f);
+		}
+
+		template<class F, class I>
+		F perlin3(I seed, F x, F y, F z)
+		{
+			F const xf = floor_lane(x);
+			F const yf = floor_lane(y);
+			F const zf = floor_lane(z);
+			I const xi = to_int(xf);
+			I const yi = to_int(yf);
+			I const zi = to_int(zf);
+			I const one = isplat<I>(1);
+			F const fx = x - xf;
+			F const fy = y - yf;
+			F const fz = z - zf;
+			F const fx1 = fx - fsplat<F>(1.0f);
+			F const fy1 = fy - fsplat<F>(1.0f);
+			F const fz1 = fz - fsplat<F>(1.0f);
+			F const u = fade(fx);
+			F const v = fade(fy);
+			F const w = fade(fz);
+			F const a0 = lerp(grad3(hash(seed, xi, yi, zi), fx, fy, fz), grad3(hash(seed, xi + one, yi, zi), fx1, fy, fz), u);
+			F const b0 = lerp(grad3(hash(seed, xi, yi + one, zi), fx, fy1, fz), grad3(hash(seed, xi + one, yi + one, zi), fx1, fy1, fz), u);
+			F const a1 = lerp(grad3(hash(seed, xi, yi, zi + one), fx, fy, fz1), grad3(hash(seed, xi + one, yi, zi + one), fx1, fy, fz1), u);
+			F const b1 = lerp(grad3(hash(seed, xi, yi + one, zi + one), fx, fy1, fz1), grad3(hash(seed, xi + one, yi + one, zi + one), fx1, fy1, fz1), u);
+			return lerp(lerp(a0, b0, v), lerp(a1, b1, v), w);
+		}
+
+		template<class F, class I>
+		F simplex_corner2(I h, F x, F y)
+		{
+			F t = fsplat<F>(0.5f) - x * x - y * y;
+			t = select(less(t, fsplat<F>(0.0f)), fsplat<F>(0.0f), t);
+			t = t * t;
+			return t * t * grad2(h, x, y);
+		}
+
+		template<class F, class I>
+		F simplex2(I seed, F x, F y)
+		{
+			F const skew = fsplat<F>(0.36602540378f); // (sqrt(3) - 1) / 2
+			F const unskew = fsplat<F>(0.21132486540f); // (3 - sqrt(3)) / 6
+			F const zero = fsplat<F>(0.0f);
+			F const one = fsplat<F>(1.0f);
+			I const zero_i = isplat<I>(0);
+			F const s = (x + y) * skew;
+			F const i = floor_lane(x + s);
+			F const j = floor_lane(y + s);
+			F const t = (i + j) * unskew;
+			F const x0 = x - (i - t);
+			F const y0 = y - (j - t);
+			auto const lower = greater(x0, y0);
+			F const i1 = select(lower, one, zero);
+			F const j1 = select(lower, zero, one);
+			F const x1 = x0 - i1 + unskew;
+			F const y1 = y0 - j1 + unskew;
+			F const x2 = x0 - one + fsplat<F>(0.42264973081f);
+			F const y2 = y0 - one + fsplat<F>(0.42264973081f);
+			I const ii = to_int(i);
+			I const jj = to_int(j);
+			I const one_i = isplat<I>(1);
+			F const n = simplex_corner2(hash(seed, ii, jj, zero_i), x0, y0)
+				+ simplex_corner2(hash(seed, ii + to_int(i1), jj + to_int(j1), zero_i), x1, y1)
+				+ simplex_corner2(hash(seed, ii + one_i, jj + one_i, zero_i), x2, y2);
+			return n * fsplat<F>(40.0f);
+		}
+
+		template<class F, class I>
+		F simplex_corner3(I h, F x, F y, F z)
+		{
+			F t = fsplat<F>(0.6f) - x * x - y * y - z * z;
+			t = select(less(t, fsplat<F>(0.0f)), fsplat<F>(0.0f), t);
+			t = t * t;
+			return t * t * grad3(h, x, y, z);
+		}
+
+		template<class F, class I>
+		F simplex3(I seed, F x, F y, F z)
+		{
+			F const skew = fsplat<F>(1.0f / 3.0f);
+			F const unskew = fsplat<F>(1.0f / 6.0f);
+			F const zero = fsplat<F>(0.0f);
+			F const one = fsplat<F>(1.0f);
+			F const s = (x + y + z) * skew;
+			F const i = floor_lane(x + s);
+			F const j = floor_lane(y + s);
+			F const k = floor_lane(z + s);
+			F const t = (i + j + k) * unskew;
+			F const x0 = x - (i - t);
+			F const y0 = y - (j - t);
+			F const z0 = z - (k - t);
+			// Which of the six tetrahedra the point is in, from the order of x0, y0 and z0.
+			auto const xy = greater_equal(x0, y0);
+			auto const yz = greater_equal(y0, z0);
+			auto const xz = greater_equal(x0, z0);
+			F const i1 = select(mask_and(xy, xz), one, zero);
+			F const j1 = select(mask_and(mask_not(xy), yz), one, zero);
+			F const k1 = select(mask_and(mask_not(xz), mask_not(yz)), one, zero);
+			F const i2 = select(mask_or(xy, xz), one, zero);
+			F const j2 = select(mask_or(mask_not(xy), yz), one, zero);
+			F const k2 = select(mask_and(xz, yz), zero, one);
+			F const x1 = x0 - i1 + unskew;
+			F const y1 = y0 - j1 + unskew;
+			F const z1 = z0 - k1 + unskew;
+			F const x2 = x0 - i2 + fsplat<F>(2.0f / 6.0f);
+			F const y2 = y0 - j2 + fsplat<F>(2.0f / 6.0f);
+			F const z2 = z0 - k2 + fsplat<F>(2.0f / 6.0f);
+			F const x3 = x0 - fsplat<F>(0.5f);
+			F const y3 = y0 - fsplat<F>(0.5f);
+			F const z3 = z0 - fsplat<F>(0.5f);
+			I const ii = to_int(i);
+			I const jj = to_int(j);
+			I const kk = to_int(k);
+			I const one_i = isplat<I>(1);
+			F const n = simplex_corner3(hash(seed, ii, jj, kk), x0, y0, z0)
+				+ simplex_corner3(hash(seed, ii + to_int(i1), jj + to_int(j1), kk + to_int(k1)), x1, y1, z1)
+				+ simplex_corner3(hash(seed, ii + to_int(i2), jj + to_int(j2), kk + to_int(k2)), x2, y2, z2)
+				+ simplex_corner3(hash(seed, ii + one_i, jj + one_i, kk + one_i), x3, y3, z3);
+			return n * fsplat<F>(32.0f);
+		}
+
+		// Per-octave parameters, computed once per call so every lane and path uses identical values.
+		struct s_octaves
+		{
+			std::uint32_t count;
+			std::uint32_t seeds[max_octaves];
+			float frequencies[max_octaves];
+			float amplitudes[max_octaves];
+			float normalize;
+		};
+
+		s_octaves octaves(s_noise_settings const& settings)
+		{
+			s_octaves result;
+			result.count = std::clamp(settings.octaves, 1u, max_octaves);
+			float frequency = settings.frequency;
+			float amplitude = 1.0f;
+			float total = 0.0f;
+			for (std::uint32_t octave = 0; octave < result.count; ++octave)
+			{
+				result.seeds[octave] = static_cast<std::uint32_t>(rand_at(settings.seed, octave));
+				result.frequencies[octave] = frequency;
+				result.amplitudes[octave] = amplitude;
+				total += amplitude;
+				frequency *= settings.lacunarity;
+				amplitude *= settings.gain;
+			}
+			result.normalize = total != 0.0f ? 1.0f / total : 1.0f;
+			return result;
+		}
+
+		template<class F>
+		F fractal2(s_noise_settings const& settings, s_octaves const& oct, F x, F y)
+		{
+			using I = typename s_int_lane<F>::type;
+			F sum = fsplat<F>(0.0f);
+			for (std::uint32_t octave = 0; octave < oct.count; ++octave)
+			{
+				I const seed = isplat<I>(oct.seeds[octave]);
+				F const frequency = fsplat<F>(oct.frequencies[octave]);
+				F const fx = x * frequency;
+				F const fy = y * frequency;
+				F sample;
+				switch (settings.type)
+				{
+				case e_noise::value: sample = value2(seed, fx, fy); break;
+				case e_noise::simplex: sample = simplex2(seed, fx, fy); break;
+				default: sample = perlin2(seed, fx, fy); break;
+				}
+				sum = sum + sample * fsplat<F>(oct.amplitudes[octave]);
+			}
+			return sum * fsplat<F>(oct.normalize);
+		}
+
+		template<class F>
+		F fractal3(s_noise_settings const& settings, s_octaves const& oct, F x, F y, F z)
+		{
+			using I = typename s_int_lane<F>::type;
+			F sum = fsplat<F>(0.0f);
+			for (std::uint32_t octave = 0; octave < oct.count; ++octave)
+			{
+				I const seed = isplat<I>(oct.seeds[octave]);
+				F const frequency = fsplat<F>(oct.frequencies[octave]);
+				F const fx = x * frequency;
+				F const fy = y * frequency;
+				F const fz = z * frequency;
+				F sample;
+				switch (settings.type)
+				{
+				case e_noise::value: sample = value3(seed, fx, fy, fz); break;
+				case e_noise::simplex: sample = simplex3(seed, fx, fy, fz); break;
+				default: sample = perlin3(seed, fx, fy, fz); break;
+				}
+				sum = sum + sample * fsplat<F>(oct.amplitudes[octave]);
+			}
+			return sum * fsplat<F>(oct.normalize);
+		}
+
+		// Fills one row of width samples starting at x0 with the given y (and z).
+		template<class Sample>
+		void fill_row(float* out, std::int32_t width, float x0, float step, Sample sample)
+		{
+			std::int32_t col = 0;
+#if defined(__AVX2__)
+			s_f8 const x0_v = fsplat<s_f8>(x0);
+			s_f8 const step_v = fsplat<s_f8>(step);
+			__m256i const lanes = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+			for (; width - col >= 8; col += 8)
+			{
+				s_f8 const col_v = to_float(s_i8{ _mm256_add_epi32(_mm256_set1_epi32(col), lanes) });
+				_mm256_storeu_ps(out + col, sample(x0_v + col_v * step_v).v);
+			}
+#endif
+			for (; col < width; ++col)
+			{
+				out[col] = sample(x0 + static_cast<float>(col) * step);
+			}
+		}
+	}
+
+	float noise2(s_noise_settings const& settings, float x, float y)
+	{
+		return fractal2(settings, octaves(settings), x, y);
+	}
+
+	float noise3(s_noise_settings const& settings, float x, float y, float z)
+	{
+		return fractal3(settings, octaves(settings), x, y, z);
+	}
+
+	void noise2(s_noise_settings const& settings, std::span<float> out, std::int32_t width, std::int32_t height, float x0, float y0, float step)
+	{
+		if (width <= 0 || height <= 0 || out.size() < static_cast<std::size_t>(width) * height)
+		{
+			return;
+		}
+		s_octaves const oct = octaves(settings);
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			float const y = y0 + static_cast<float>(row) * step;
+			fill_row(out.data() + static_cast<std::size_t>(row) * width, width, x0, step, [&](auto x) {
+				using F = decltype(x);
+				return fractal2(settings, oct, x, fsplat<F>(y));
+			});
+		}
+	}
+
+	void noise3(s_noise_settings const& settings, std::span<float> out, std::int32_t width, std::int32_t height, std::int32_t depth, float x0, float y0, float z0, float step)
+	{
+		if (width <= 0 || height <= 0 || depth <= 0 || out.size() < static_cast<std::size_t>(width) * height * depth)
+		{
+			return;
+		}
+		s_octaves const oct = octaves(settings);
+		for (std::int32_t layer = 0; layer < depth; ++layer)
+		{
+			float const z = z0 + static_cast<float>(layer) * step;
+			for (std::int32_t row = 0; row < height; ++row)
+			{
+				float const y = y0 + static_cast<float>(row) * step;
+				fill_row(out.data() + (static_cast<std::size_t>(layer) * height + row) * width, width, x0, step, [&](auto x) {
+					using F = decltype(x);
+					return fractal3(settings, oct, x, fsplat<F>(y), fsplat<F>(z));
+				});
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace tt
+{
+	enum class e_noise : std::uint8_t
+	{
+		value,
+		perlin,
+		simplex,
+	};
+
+	// Fractal (fBm) noise parameters. Any 32-bit seed works, e.g. one from c_rand::rand_int<std::uint32_t>()
+	// or det_rand_int. Each octave gets its own seed derived with rand_at(seed, octave).
+	struct s_noise_settings
+	{
+		e_noise type = e_noise::perlin;
+		std::uint32_t seed = 0;
+		float frequency = 1.0f / 64.0f;
+		std::uint32_t octaves = 1;
+		float lacunarity = 2.0f;
+		float gain = 0.5f;
+	};
+
+	// Single samples, roughly in [-1, 1].
+	float noise2(s_noise_settings const& settings, float x, float y);
+	float noise3(s_noise_settings const& settings, float x, float y, float z);
+
+	// Fills out[row * width + col] with noise2(x0 + col * step, y0 + row * step). Uses AVX2 when the
+	// library is built with it. Every value is bit-identical to the single sample, so chunks can be
+	// generated on any machine and stitched together.
+	void noise2(s_noise_settings const& settings, std::span<float> out, std::int32_t width, std::int32_t height, float x0, float y0, float step = 1.0f);
+
+	// Fills out[(layer * height + row) * width + col] with noise3(x0 + col * step, y0 + row * step, z0 + layer * step).
+	void noise3(s_noise_settings const& settings, std::span<float> out, std::int32_t width, std::int32_t height, std::int32_t depth, float x0, float y0, float z0, float step = 1.0f);
+}
@@ -0,0 +1,511 @@
+#include "path.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <thread>
+
+namespace tt
+{
+	namespace
+	{
+		constexpr std::uint32_t straight_cost = 10;
+		constexpr std::uint32_t diagonal_cost = 14;
+		constexpr std::uint32_t no_node = 0xffffffff;
+
+		std::uint32_t octile(c_vec2i a, c_vec2i b)
+		{
+			std::uint32_t const dx = static_cast<std::uint32_t>(std::abs(a.x() - b.x()));
+			std::uint32_t const dy = static_cast<std::uint32_t>(std::abs(a.y() - b.y()));
+			return dx > dy
+				? straight_cost * dx + (diagonal_cost - straight_cost) * dy
+				: straight_cost * dy + (diagonal_cost - straight_cost) * dx;
+		}
+
+		std::int32_t sign(std::int32_t v)
+		{
+			return (v > 0) - (v < 0);
+		}
+
+		// Walks a bit line from pos (exclusive) in direction dir and returns the first position that
+		// is the goal or has a forced neighbour, or -1 when a blocked cell comes first. side_a and
+		// side_b are the lines on either side. A side cell is a forced neighbour when it is open but
+		// the side cell just behind it is blocked.
+		std::int32_t scan(std::uint64_t const* line, std::uint64_t const* side_a, std::uint64_t const* side_b, std::int32_t words, std::int32_t pos, std::int32_t dir, std::int32_t goal)
+		{
+			if (dir > 0)
+			{
+				std::int32_t const start = pos + 1;
+				for (std::int32_t k = start >> 6; k < words; ++k)
+				{
+					std::uint64_t const a = side_a[k];
+					std::uint64_t const b = side_b[k];
+					std::uint64_t const a_behind = (a << 1) | (k > 0 ? side_a[k - 1] >> 63 : 1);
+					std::uint64_t const b_behind = (b << 1) | (k > 0 ? side_b[k - 1] >> 63 : 1);
+					std::uint64_t events = line[k] | (~a & a_behind) | (~b & b_behind);
+					if (goal >= 0 && (goal >> 6) == k)
+					{
+						events |= std::uint64_t(1) << (goal & 63);
+					}
+					if (k == (start >> 6))
+					{
+						events &= ~std::uint64_t(0) << (start & 63);
+					}
+					if (events != 0)
+					{
+						int const bit = std::countr_zero(events);
+						return (line[k] >> bit) & 1 ? -1 : k * 64 + bit;
+					}
+				}
+				return -1;
+			}
+
+			std::int32_t const start = pos - 1;
+			if (start < 0)
+			{
+				return -1;
+			}
+			for (std::int32_t k = start >> 6; k >= 0; --k)
+			{
+				std::uint64_t const a = side_a[k];
+				std::uint64_t const b = side_b[k];
+				std::uint64_t const a_behind = (a >> 1) | (k + 1 < words ? side_a[k + 1] << 63 : std::uint64_t(1) << 63);
+				std::uint64_t const b_behind = (b >> 1) | (k + 1 < words ? side_b[k + 1] << 63 : std::uint64_t(1) << 63);
+				std::uint64_t events = line[k] | (~a & a_behind) | (~b & b_behind);
+				if (goal >= 0 && (goal >> 6) == k)
+				{
+					events |= std::uint64_t(1) << (goal & 63);
+				}
+				if (k == (start >> 6))
+				{
+					events &= ~std::uint64_t(0) >> (63 - (start & 63));
+				}
+				if (events != 0)
+				{
+					int const bit = 63 - std::countl_zero(events);
+					return (line[k] >> bit) & 1 ? -1 : k * 64 + bit;
+				}
+			}
+			return -1;
+		}
+
+		bool jump_straight(c_occupancy_grid const& grid, c_vec2i from, c_vec2i dir, c_vec2i goal, c_vec2i& out)
+		{
+			if (dir.y() == 0)
+			{
+				std::int32_t const x = scan(grid.row(from.y()), grid.row(from.y() - 1), grid.row(from.y() + 1), grid.row_words(),
+					from.x(), dir.x(), goal.y() == from.y() ? goal.x() : -1);
+				out = { x, from.y() };
+				return x >= 0;
+			}
+			std::int32_t const y = scan(grid.column(from.x()), grid.column(from.x() - 1), grid.column(from.x() + 1), grid.column_words(),
+				from.y(), dir.y(), goal.x() == from.x() ? goal.y() : -1);
+			out = { from.x(), y };
+			return y >= 0;
+		}
+
+		bool jump_diagonal(c_occupancy_grid const& grid, c_vec2i from, c_vec2i dir, c_vec2i goal, c_vec2i& out)
+		{
+			c_vec2i cell = from;
+			c_vec2i found;
+			while (true)
+			{
+				if (!grid.walkable(cell.x() + dir.x(), cell.y()) || !grid.walkable(cell.x(), cell.y() + dir.y()))
+				{
+					return false;
+				}
+				cell += dir;
+				if (!grid.walkable(cell))
+				{
+					return false;
+				}
+				if (cell == goal
+					|| jump_straight(grid, cell, { dir.x(), 0 }, goal, found)
+					|| jump_straight(grid, cell, { 0, dir.y() }, goal, found))
+				{
+					out = cell;
+					return true;
+				}
+			}
+		}
+	}
+
+	c_occupancy_grid::c_occupancy_grid(std::int32_t width, std::int32_t height)
+		: m_width(width > 0 ? width : 0)
+		, m_height(height > 0 ? height : 0)
+		, m_row_words((m_width + 63) / 64)
+		, m_column_words((m_height + 63) / 64)
+		, m_rows(static_cast<std::size_t>(m_row_words) * m_height, 0)
+		, m_columns(static_cast<std::size_t>(m_column_words) * m_width, 0)
+		, m_blocked_line(std::max(m_row_words, m_column_words), ~std::uint64_t(0))
+	{
+		// Bits past the end of a line read as blocked so scans stop at the edge.
+		if (m_width & 63)
+		{
+			for (std::int32_t y = 0; y < m_height; ++y)
+			{
+				m_rows[static_cast<std::size_t>(y) * m_row_words + m_row_words - 1] = ~std::uint64_t(0) << (m_width & 63);
+			}
+		}
+		if (m_height & 63)
+		{
+			for (std::int32_t x = 0; x < m_width; ++x)
+			{
+				m_columns[static_cast<std::size_t>(x) * m_column_words + m_column_words - 1] = ~std::uint64_t(0) << (m_height & 63);
+			}
+		}
+	}
+
+	void c_occupancy_grid::set_blocked(std::int32_t x, std::int32_t y, bool blocked)
+	{
+		if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+		{
+			return;
+		}
+		std::uint64_t& row_word = m_rows[static_cast<std::size_t>(y) * m_row_words + (x >> 6)];
+		std::uint64_t& column_word = m_columns[static_cast<std::size_t>(x) * m_column_words + (y >> 6)];
+		std::uint64_t const row_bit = std::uint64_t(1) << (x & 63);
+		std::uint64_t const column_bit = std::uint64_t(1) << (y & 63);
+		if (blocked)
+		{
+			row_word |= row_bit;
+			column_word |= column_bit;
+		}
+		else
+		{
+			row_word &= ~row_bit;
+			column_word &= ~column_bit;
+		}
+	}
+
+	std::uint64_t const* c_occupancy_grid::row(std::int32_t y) const
+	{
+		if (y < 0 || y >= m_height)
+		{
+			return m_blocked_line.data();
+		}
+		return m_rows.data() + static_cast<std::size_t>(y) * m_row_words;
+	}
+
+	std::uint64_t const* c_occupancy_grid::column(std::int32_t x) const
+	{
+		if (x < 0 || x >= m_width)
+		{
+			return m_blocked_line.data();
+		}
+		return m_columns.data() + static_cast<std::size_t>(x) * m_column_words;
+	}
+
+	c_path_context::c_path_context()
+		: m_width(0)
+		, m_generation(0)
+	{
+	}
+
+	bool c_path_context::find(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal, std::vector<c_vec2i>& path, e_path_search search)
+	{
+		path.clear();
+		if (!grid.walkable(start) || !grid.walkable(goal))
+		{
+			return false;
+		}
+		reset(grid);
+		bool const found = search == e_path_search::jps ? search_jps(grid, start, goal) : search_astar(grid, start, goal);
+		if (!found)
+		{
+			return false;
+		}
+
+		// Parent links may skip cells (jump points lie on straight or diagonal lines), so fill in
+		// every step while walking back from the goal.
+		std::uint32_t node = static_cast<std::uint32_t>(goal.y()) * m_width + goal.x();
+		c_vec2i cell = goal;
+		path.push_back(cell);
+		while (m_parent[node] != no_node)
+		{
+			node = m_parent[node];
+			c_vec2i const parent_cell(static_cast<std::int32_t>(node % m_width), static_cast<std::int32_t>(node / m_width));
+			c_vec2i const step(sign(parent_cell.x() - cell.x()), sign(parent_cell.y() - cell.y()));
+			while (!(cell == parent_cell))
+			{
+				cell += step;
+				path.push_back(cell);
+			}
+		}
+		std::reverse(path.begin(), path.end());
+		return true;
+	}
+
+	void c_path_context::reset(c_occupancy_grid const& grid)
+	{
+		std::size_t const cells = static_cast<std::size_t>(grid.width()) * grid.height();
+		if (m_width != grid.width() || m_seen.size() != cells)
+		{
+			m_width = grid.width();
+			m_seen.assign(cells, 0);
+			m_g.resize(cells);
+			m_parent.resize(cells);
+			m_closed.resize((cells + 63) / 64);
+			m_generation = 0;
+		}
+		if (++m_generation == 0)
+		{
+			std::fill(m_seen.begin(), m_seen.end(), 0);
+			m_generation = 1;
+		}
+		std::fill(m_closed.begin(), m_closed.end(), 0);
+		m_open.clear();
+	}
+
+	void c_path_context::push(std::uint32_t node, std::uint32_t parent, std::uint32_t g, c_vec2i goal)
+	{
+		if (seen(node) && (closed(node) || m_g[node] <= g))
+		{
+			return;
+		}
+		m_seen[node] = m_generation;
+		m_g[node] = g;
+		m_parent[node] = parent;
+		c_vec2i const cell(static_cast<std::int32_t>(node % m_width), static_cast<std::int32_t>(node / m_width));
+		std::uint32_t const h = octile(cell, goal);
+		m_open.push_back({ g + h, h, node });
+		std::push_heap(m_open.begin(), m_open.end(), [](s_open const& a, s_open const& b) {
+			return a.f != b.f ? a.f > b.f : a.h > b.h;
+		});
+	}
+
+	bool c_path_context::pop(std::uint32_t& node)
+	{
+		while (!m_open.empty())
+		{
+			std::pop_heap(m_open.begin(), m_open.end(), [](s_open const& a, s_open const& b) {
+				return a.f != b.f ? a.f > b.f : a.h > b.h;
+			});
+			s_open const top = m_open.back();
+			m_open.pop_back();
+			// Entries are not removed when a node gets a cheaper g, so skip the stale ones.
+			if (closed(top.node) || top.f != m_g[top.node] + top.h)
+			{
+				continue;
+			}
+			m_closed[top.node >> 6] |= std::uint64_t(1) << (top.node & 63);
+			node = top.node;
+			return true;
+		}
+		return false;
+	}
+
+	bool c_path_context::search_astar(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal)
+	{
+		std::uint32_t const goal_node = static_cast<std::uint32_t>(goal.y()) * m_width + goal.x();
+		push(static_cast<std::uint32_t>(start.y()) * m_width + start.x(), no_node, 0, goal);
+		std::uint32_t node;
+		while (pop(node))
+		{
+			if (node == goal_node)
+			{
+				return true;
+			}
+			c_vec2i const cell(static_cast<std::int32_t>(node % m_width), static_cast<std::int32_t>(node / m_width));
+			for (std::uint8_t d = 0; d < static_cast<std::uint8_t>(e_compass_direction::count); ++d)
+			{
+				c_vec2i const dir = direction_offset(static_cast<e_compass_direction>(d));
+				c_vec2i const next = cell + dir;
+				if (!grid.walkable(next))
+				{
+					continue;
+				}
+				bool const diagonal = dir.x() != 0 && dir.y() != 0;
+				if (diagonal && (!grid.walkable(cell.x() + dir.x(), cell.y()) || !grid.walkable(cell.x(), cell.y() + dir.y())))
+				{
+					continue;
+				}
+				push(static_cast<std::uint32_t>(next.y()) * m_width + next.x(), node, m_g[node] + (diagonal ? diagonal_cost : straight_cost), goal);
+			}
+		}
+		return false;
+	}
+
+	bool c_path_context::search_jps(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal)
+	{
+		std::uint32_t const goal_node = static_cast<std::uint32_t>(goal.y()) * m_width + goal.x();
+		push(static_cast<std::uint32_t>(start.y()) * m_width + start.x(), no_node, 0, goal);
+		std::uint32_t node;
+		c_vec2i dirs[static_cast<std::size_t>(e_compass_direction::count)];
+		while (pop(node))
+		{
+			if (node == goal_node)
+			{
+				return true;
+			}
+			c_vec2i const cell(static_cast<std::int32_t>(node % m_width), static_cast<std::int32_t>(node / m_width));
+			auto const open = [&](std::int32_t dx, std::int32_t dy) { return grid.walkable(cell.x() + dx, cell.y() + dy); };
+
+			// Pruned neighbour directions for the no-corner-cutting rule.
+			std::size_t count = 0;
+			if (m_parent[node] == no_node)
+			{
+				for (std::uint8_t d = 0; d < static_cast<std::uint8_t>(e_compass_direction::count); ++d)
+				{
+					c_vec2i const dir = direction_offset(static_cast<e_compass_direction>(d));
+					if (open(dir.x(), dir.y()) && (dir.x() == 0 || dir.y() == 0 || (open(dir.x(), 0) && open(0, dir.y()))))
+					{
+						dirs[count++] = dir;
+					}
+				}
+			}
+			else
+			{
+				std::uint32_t const parent = m_parent[node];
+				std::int32_t const dx = sign(cell.x() - static_cast<std::int32_t>(parent % m_width));
+				std::int32_t const dy = sign(cell.y() - static_cast<std::int32_t>(parent / m_width));
+				if (dx != 0 && dy != 0)
+				{
+					bool const vertical = open(0, dy);
+					bool const horizontal = open(dx, 0);
+					if (vertical) dirs[count++] = { 0, dy };
+					if (horizontal) dirs[count++] = { dx, 0 };
+					if (vertical && horizontal) dirs[count++] = { dx, dy };
+				}
+				else if (dx != 0)
+				{
+					bool const ahead = open(dx, 0);
+					bool const below = open(0, 1);
+					bool const above = open(0, -1);
+					if (ahead)
+					{
+						dirs[count++] = { dx, 0 };
+						if (below) dirs[count++] = { dx, 1 };
+						if (above) dirs[count++] = { dx, -1 };
+					}
+					if (below) dirs[count++] = { 0, 1 };
+					if (above) dirs[count++] = { 0, -1 };
+				}
+				else
+				{
+					bool const ahead = open(0, dy);
+					bool const right = open(1, 0);
+					bool const left = open(-1, 0);
+					if (ahead)
+					{
+						dirs[count++] = { 0, dy };
+						if (right) dirs[count++] = { 1, dy };
+						if (left) dirs[count++] = { -1, dy };
+					}
+					if (right) dirs[count++] = { 1, 0 };
+					if (left) dirs[count++] = { -1, 0 };
+				}
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				c_vec2i const dir = dirs[i];
+				c_vec2i jump_point;
+				bool const found = dir.x() != 0 && dir.y() != 0
+					? jump_diagonal(grid, cell, dir, goal, jump_point)
+					: jump_straight(grid, cell, dir, goal, jump_point);
+				if (found)
+				{
+					push(static_cast<std::uint32_t>(jump_point.y()) * m_width + jump_point.x(), node, m_g[node] + octile(cell, jump_point), goal);
+				}
+			}
+		}
+		return false;
+	}
+
+	c_path_batch::c_path_batch(std::uint32_t threads)
+		: m_batch(0)
+		, m_busy(0)
+		, m_stopping(false)
+		, m_grid(nullptr)
+		, m_search(e_path_search::jps)
+		, m_next(0)
+	{
+		if (threads == 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		m_contexts.resize(threads);
+		m_threads.reserve(threads - 1);
+		for (std::uint32_t t = 1; t < threads; ++t)
+		{
+			m_threads.emplace_back(&c_path_batch::work, this, t);
+		}
+	}
+
+	c_path_batch::~c_path_batch()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_start.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void c_path_batch::find(c_occupancy_grid const& grid, std::span<s_path_query const> queries, std::span<std::vector<c_vec2i>> paths, e_path_search search)
+	{
+		std::size_t const count = std::min(queries.size(), paths.size());
+		m_grid = &grid;
+		m_queries = queries.first(count);
+		m_paths = paths.first(count);
+		m_search = search;
+		m_next = 0;
+
+		// A single query is not worth waking the workers for.
+		bool const wake = count > 1 && !m_threads.empty();
+		if (wake)
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				++m_batch;
+				m_busy = static_cast<std::uint32_t>(m_threads.size());
+			}
+			m_start.notify_all();
+		}
+		run(m_contexts[0]);
+		if (wake)
+		{
+			std::unique_lock lock(m_mutex);
+			m_done.wait(lock, [this] { return m_busy == 0; });
+		}
+	}
+
+	void c_path_batch::run(c_path_context& context)
+	{
+		for (std::size_t i = m_next++; i < m_queries.size(); i = m_next++)
+		{
+			context.find(*m_grid, m_queries[i].start, m_queries[i].goal, m_paths[i], m_search);
+		}
+	}
+
+	void c_path_batch::work(std::uint32_t index)
+	{
+		std::uint64_t batch = 0;
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_start.wait(lock, [&] { return m_stopping || m_batch != batch; });
+				if (m_stopping)
+				{
+					return;
+				}
+				batch = m_batch;
+			}
+			run(m_contexts[index]);
+			bool last;
+			{
+				std::lock_guard lock(m_mutex);
+				last = --m_busy == 0;
+			}
+			if (last)
+			{
+				m_done.notify_one();
+			}
+		}
+	}
+}
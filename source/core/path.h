@@ -0,0 +1,141 @@
+#pragma once
+
+#include "core/math.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace tt
+{
+	// Walkability grid with one bit per cell (1 = blocked). Kept both row-major and column-major so
+	// searches can scan 64 cells at a time along either axis. Cells outside the grid are blocked.
+	class c_occupancy_grid
+	{
+	public:
+		c_occupancy_grid(std::int32_t width, std::int32_t height);
+
+		std::int32_t width() const { return m_width; }
+		std::int32_t height() const { return m_height; }
+
+		bool walkable(std::int32_t x, std::int32_t y) const
+		{
+			if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+			{
+				return false;
+			}
+			return ((m_rows[static_cast<std::size_t>(y) * m_row_words + (x >> 6)] >> (x & 63)) & 1) == 0;
+		}
+
+		bool walkable(c_vec2i cell) const
+		{
+			return walkable(cell.x(), cell.y());
+		}
+
+		void set_blocked(std::int32_t x, std::int32_t y, bool blocked);
+
+		// Bit lines of row_words()/column_words() words. Lines outside the grid read as fully blocked.
+		std::uint64_t const* row(std::int32_t y) const;
+		std::uint64_t const* column(std::int32_t x) const;
+		std::int32_t row_words() const { return m_row_words; }
+		std::int32_t column_words() const { return m_column_words; }
+
+	private:
+		std::int32_t m_width;
+		std::int32_t m_height;
+		std::int32_t m_row_words;
+		std::int32_t m_column_words;
+		std::vector<std::uint64_t> m_rows;
+		std::vector<std::uint64_t> m_columns;
+		std::vector<std::uint64_t> m_blocked_line;
+	};
+
+	enum class e_path_search : std::uint8_t
+	{
+		astar,
+		jps,
+	};
+
+	// Search state for one thread. Buffers are sized to the grid on first use and reused afterwards,
+	// so queries on the same grid do not allocate. Moves are the 8 e_compass_direction steps; a
+	// diagonal step needs both cells beside it to be walkable. Straight steps cost 10, diagonal 14.
+	class c_path_context
+	{
+	public:
+		c_path_context();
+
+		// On success path holds every cell from start to goal inclusive. Returns false and leaves
+		// path empty when there is no path.
+		bool find(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal, std::vector<c_vec2i>& path, e_path_search search = e_path_search::jps);
+
+	private:
+		struct s_open
+		{
+			std::uint32_t f;
+			std::uint32_t h;
+			std::uint32_t node;
+		};
+
+		void reset(c_occupancy_grid const& grid);
+		bool seen(std::uint32_t node) const { return m_seen[node] == m_generation; }
+		bool closed(std::uint32_t node) const { return (m_closed[node >> 6] >> (node & 63)) & 1; }
+		void push(std::uint32_t node, std::uint32_t parent, std::uint32_t g, c_vec2i goal);
+		bool pop(std::uint32_t& node);
+		bool search_astar(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal);
+		bool search_jps(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal);
+
+		std::int32_t m_width;
+		std::uint32_t m_generation;
+		std::vector<std::uint32_t> m_seen;
+		std::vector<std::uint32_t> m_g;
+		std::vector<std::uint32_t> m_parent;
+		std::vector<std::uint64_t> m_closed;
+		std::vector<s_open> m_open;
+	};
+
+	struct s_path_query
+	{
+		c_vec2i start;
+		c_vec2i goal;
+	};
+
+	// Runs many queries on worker threads, one c_path_context per thread. The workers are started once
+	// and sleep between batches, so a per-frame batch does not pay for creating threads.
+	class c_path_batch
+	{
+	public:
+		// 0 uses one thread per hardware thread. The calling thread is one of them.
+		explicit c_path_batch(std::uint32_t threads = 0);
+		~c_path_batch();
+		c_path_batch(c_path_batch const&) = delete;
+		c_path_batch& operator=(c_path_batch const&) = delete;
+
+		// paths[i] receives the path for queries[i], or is cleared when there is none. Returns once
+		// every query is done.
+		void find(c_occupancy_grid const& grid, std::span<s_path_query const> queries, std::span<std::vector<c_vec2i>> paths, e_path_search search = e_path_search::jps);
+
+	private:
+		void run(c_path_context& context);
+		void work(std::uint32_t index);
+
+		std::vector<c_path_context> m_contexts;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_start;
+		std::condition_variable m_done;
+		std::uint64_t m_batch;
+		std::uint32_t m_busy;
+		bool m_stopping;
+
+		// The current batch, valid while find() runs.
+		c_occupancy_grid const* m_grid;
+		std::span<s_path_query const> m_queries;
+		std::span<std::vector<c_vec2i>> m_paths;
+		e_path_search m_search;
+		std::atomic<std::size_t> m_next;
+	};
+}
@@ -0,0 +1,266 @@
+#include "rand.h"
+#include <cstring>
+#include <random>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace tt
+{
+	std::uint64_t random_seed()
+	{
+		std::random_device device;
+		std::uint64_t const hi = device();
+		return (hi << 32) | device();
+	}
+
+	namespace
+	{
+		// Candidates produced per block: four 64-bit lane outputs viewed as eight 32-bit values in
+		// memory order.
+		constexpr std::size_t block_size = 8;
+
+		void step_scalar(std::uint64_t (&state)[4][c_xoshiro256x4::lanes], std::uint32_t* block)
+		{
+			std::uint64_t values[c_xoshiro256x4::lanes];
+			for (std::size_t lane = 0; lane < c_xoshiro256x4::lanes; ++lane)
+			{
+				c_xoshiro256::state_t s = { state[0][lane], state[1][lane], state[2][lane], state[3][lane] };
+				values[lane] = c_xoshiro256::step(s);
+				for (std::size_t word = 0; word < 4; ++word)
+				{
+					state[word][lane] = s[word];
+				}
+			}
+			std::memcpy(block, values, sizeof(values));
+		}
+
+		// Writes the accepted candidates of one block in order and returns how many were written.
+		std::size_t reduce_block(std::uint32_t const* block, std::uint32_t* out, std::size_t remaining, std::uint32_t base, std::uint32_t range, std::uint32_t threshold)
+		{
+			std::size_t written = 0;
+			for (std::size_t i = 0; i < block_size && written < remaining; ++i)
+			{
+				if (range == 0)
+				{
+					out[written++] = base + block[i];
+					continue;
+				}
+				std::uint64_t const m = static_cast<std::uint64_t>(block[i]) * range;
+				if (static_cast<std::uint32_t>(m) >= threshold)
+				{
+					out[written++] = base + static_cast<std::uint32_t>(m >> 32);
+				}
+			}
+			return written;
+		}
+
+#if defined(__AVX2__)
+		template<int K>
+		__m256i rotl(__m256i x)
+		{
+			return _mm256_or_si256(_mm256_slli_epi64(x, K), _mm256_srli_epi64(x, 64 - K));
+		}
+
+		// One xoshiro256** step on all four lanes. The multiplications by 5 and 9 are shift-adds
+		// since AVX2 has no 64-bit multiply.
+		__m256i step_avx2(__m256i& s0, __m256i& s1, __m256i& s2, __m256i& s3)
+		{
+			__m256i const times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+			__m256i const rotated = rotl<7>(times5);
+			__m256i const result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+			__m256i const t = _mm256_slli_epi64(s1, 17);
+			s2 = _mm256_xor_si256(s2, s0);
+			s3 = _mm256_xor_si256(s3, s1);
+			s1 = _mm256_xor_si256(s1, s2);
+			s0 = _mm256_xor_si256(s0, s3);
+			s2 = _mm256_xor_si256(s2, t);
+			s3 = rotl<45>(s3);
+			return result;
+		}
+#endif
+	}
+
+	c_xoshiro256x4::c_xoshiro256x4(c_xoshiro256 base)
+		: m_buffered(0)
+	{
+		for (std::size_t lane = 0; lane < lanes; ++lane)
+		{
+			for (std::size_t word = 0; word < 4; ++word)
+			{
+				m_state[word][lane] = base.state()[word];
+			}
+			base.jump();
+		}
+	}
+
+	void c_xoshiro256x4::next4(std::uint64_t* out)
+	{
+		std::uint32_t block[block_size];
+		step_scalar(m_state, block);
+		std::memcpy(out, block, sizeof(block));
+	}
+
+	std::uint64_t c_xoshiro256x4::next_u64()
+	{
+		if (m_buffered == 0)
+		{
+			next4(m_buffer);
+			m_buffered = lanes;
+		}
+		return m_buffer[lanes - m_buffered--];
+	}
+
+	void c_xoshiro256x4::long_jump()
+	{
+		for (std::size_t lane = 0; lane < lanes; ++lane)
+		{
+			c_xoshiro256::state_t s = { m_state[0][lane], m_state[1][lane], m_state[2][lane], m_state[3][lane] };
+			c_xoshiro256::jump(s, c_xoshiro256::long_jump_table);
+			for (std::size_t word = 0; word < 4; ++word)
+			{
+				m_state[word][lane] = s[word];
+			}
+		}
+		m_buffered = 0;
+	}
+
+	c_xoshiro256x4 c_xoshiro256x4::split()
+	{
+		c_xoshiro256x4 stream = *this;
+		long_jump();
+		return stream;
+	}
+
+	void c_xoshiro256x4::fill(std::span<std::uint32_t> out, std::uint32_t min, std::uint32_t max)
+	{
+		if (min > max)
+		{
+			std::swap(min, max);
+		}
+		fill_bounded(out.data(), out.size(), min, max - min + 1);
+	}
+
+	void c_xoshiro256x4::fill(std::span<std::int32_t> out, std::int32_t min, std::int32_t max)
+	{
+		if (min > max)
+		{
+			std::swap(min, max);
+		}
+		std::uint32_t const base = static_cast<std::uint32_t>(min);
+		fill_bounded(reinterpret_cast<std::uint32_t*>(out.data()), out.size(), base, static_cast<std::uint32_t>(max) - base + 1);
+	}
+
+	void c_xoshiro256x4::fill_bounded(std::uint32_t* out, std::size_t count, std::uint32_t base, std::uint32_t range)
+	{
+		std::uint32_t const threshold = range != 0 ? (0u - range) % range : 0;
+		alignas(32) std::uint32_t block[block_size];
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		__m256i s0 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[0]));
+		__m256i s1 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[1]));
+		__m256i s2 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[2]));
+		__m256i s3 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[3]));
+		__m256i const base_v = _mm256_set1_epi32(static_cast<int>(base));
+		__m256i const range_v = _mm256_set1_epi32(static_cast<int>(range));
+		__m256i const sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		__m256i const threshold_v = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(threshold)), sign);
+		while (i < count)
+		{
+			__m256i const x = step_avx2(s0, s1, s2, s3);
+			if (count - i >= block_size)
+			{
+				if (range == 0)
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(base_v, x));
+					i += block_size;
+					continue;
+				}
+				// 32x32->64 products of the even and odd 32-bit elements.
+				__m256i const even = _mm256_mul_epu32(x, range_v);
+				__m256i const odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), range_v);
+				__m256i const hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+				__m256i const lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+				__m256i const rejected = _mm256_cmpgt_epi32(threshold_v, _mm256_xor_si256(lo, sign));
+				if (_mm256_testz_si256(rejected, rejected))
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(base_v, hi));
+					i += block_size;
+					continue;
+				}
+			}
+			_mm256_store_si256(reinterpret_cast<__m256i*>(block), x);
+			i += reduce_block(block, out + i, count - i, base, range, threshold);
+		}
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[0]), s0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[1]), s1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[2]), s2);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[3]), s3);
+#else
+		while (i < count)
+		{
+			step_scalar(m_state, block);
+			i += reduce_block(block, out + i, count - i, base, range, threshold);
+		}
+#endif
+	}
+
+	void c_xoshiro256x4::fill(std::span<float> out, float min, float max)
+	{
+		if (min > max)
+		{
+			std::swap(min, max);
+		}
+		float const span = max - min;
+		// Same clamp as rand_float(), since min + unit * span can round up to max.
+		float const below_max = std::nextafter(max, min);
+		float* dst = out.data();
+		std::size_t const count = out.size();
+		alignas(32) std::uint32_t block[block_size];
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		__m256i s0 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[0]));
+		__m256i s1 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[1]));
+		__m256i s2 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[2]));
+		__m256i s3 = _mm256_load_si256(reinterpret_cast<__m256i const*>(m_state[3]));
+		__m256 const min_v = _mm256_set1_ps(min);
+		__m256 const span_v = _mm256_set1_ps(span);
+		__m256 const scale_v = _mm256_set1_ps(0x1.0p-24f);
+		__m256 const below_max_v = _mm256_set1_ps(below_max);
+		for (; count - i >= block_size; i += block_size)
+		{
+			__m256i const x = step_avx2(s0, s1, s2, s3);
+			__m256 const unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), scale_v);
+			_mm256_storeu_ps(dst + i, _mm256_min_ps(below_max_v, _mm256_add_ps(min_v, _mm256_mul_ps(unit, span_v))));
+		}
+		if (i < count)
+		{
+			_mm256_store_si256(reinterpret_cast<__m256i*>(block), step_avx2(s0, s1, s2, s3));
+		}
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[0]), s0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[1]), s1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[2]), s2);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(m_state[3]), s3);
+#else
+		for (; count - i >= block_size; i += block_size)
+		{
+			step_scalar(m_state, block);
+			for (std::size_t j = 0; j < block_size; ++j)
+			{
+				float const unit = static_cast<float>(block[j] >> 8) * 0x1.0p-24f;
+				dst[i + j] = std::min(min + unit * span, below_max);
+			}
+		}
+		if (i < count)
+		{
+			step_scalar(m_state, block);
+		}
+#endif
+		for (std::size_t j = 0; i < count; ++i, ++j)
+		{
+			float const unit = static_cast<float>(block[j] >> 8) * 0x1.0p-24f;
+			dst[i] = std::min(min + unit * span, below_max);
+		}
+	}
+}
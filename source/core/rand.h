@@ -0,0 +1,329 @@
+#pragma once
+
+#include "core/math.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace tt
+{
+	// Returns 64 bits from the device's non-deterministic random source.
+	std::uint64_t random_seed();
+
+	// Returns a uniform value in [0, range) using Lemire's multiply-shift reduction. A range of 0
+	// means the full 2^32 range. next is only called again when a draw lands in the biased region.
+	template<class Next>
+	constexpr std::uint32_t bounded_u32(std::uint32_t range, Next&& next)
+	{
+		std::uint32_t x = next();
+		if (range == 0)
+		{
+			return x;
+		}
+		std::uint64_t m = static_cast<std::uint64_t>(x) * range;
+		std::uint32_t l = static_cast<std::uint32_t>(m);
+		if (l < range)
+		{
+			std::uint32_t const threshold = (0u - range) % range;
+			while (l < threshold)
+			{
+				x = next();
+				m = static_cast<std::uint64_t>(x) * range;
+				l = static_cast<std::uint32_t>(m);
+			}
+		}
+		return static_cast<std::uint32_t>(m >> 32);
+	}
+
+	// 64-bit version of bounded_u32. A range of 0 means the full 2^64 range.
+	template<class Next>
+	constexpr std::uint64_t bounded_u64(std::uint64_t range, Next&& next)
+	{
+		std::uint64_t x = next();
+		if (range == 0)
+		{
+			return x;
+		}
+		std::uint64_t l = x * range;
+		if (l < range)
+		{
+			std::uint64_t const threshold = (0ull - range) % range;
+			while (l < threshold)
+			{
+				x = next();
+				l = x * range;
+			}
+		}
+		return mul_hi(x, range);
+	}
+
+	// Shared rand_int/rand_float/fill interface. Derived provides next_u32() and next_u64().
+	template<class Derived>
+	class c_rand_engine
+	{
+	public:
+		template<class T>
+		T rand_int(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max())
+		{
+			static_assert(std::is_integral_v<T>, "T must be an integral type");
+			if (min > max)
+			{
+				std::swap(min, max);
+			}
+			using u_t = std::make_unsigned_t<T>;
+			u_t const span = static_cast<u_t>(static_cast<u_t>(max) - static_cast<u_t>(min));
+			if constexpr (sizeof(T) <= sizeof(std::uint32_t))
+			{
+				std::uint32_t const offset = bounded_u32(static_cast<std::uint32_t>(span) + 1u, [this] { return derived().next_u32(); });
+				return static_cast<T>(static_cast<u_t>(static_cast<u_t>(min) + offset));
+			}
+			else
+			{
+				std::uint64_t const offset = bounded_u64(static_cast<std::uint64_t>(span) + 1u, [this] { return derived().next_u64(); });
+				return static_cast<T>(static_cast<u_t>(static_cast<u_t>(min) + offset));
+			}
+		}
+
+		// Returns a value in [min, max), or min when they are equal.
+		template<class T>
+		T rand_float(T min, T max)
+		{
+			static_assert(std::is_floating_point_v<T>, "T must be a floating-point type");
+			if (min > max)
+			{
+				std::swap(min, max);
+			}
+			T unit;
+			if constexpr (std::is_same_v<T, float>)
+			{
+				unit = static_cast<float>(derived().next_u32() >> 8) * 0x1.0p-24f;
+			}
+			else
+			{
+				unit = static_cast<T>(derived().next_u64() >> 11) * static_cast<T>(0x1.0p-53);
+			}
+			// min + unit * (max - min) can round up to max.
+			return std::min(min + unit * (max - min), std::nextafter(max, min));
+		}
+
+		template<class T>
+		void fill(std::span<T> out, T min, T max)
+		{
+			for (T& val : out)
+			{
+				if constexpr (std::is_integral_v<T>)
+				{
+					val = rand_int<T>(min, max);
+				}
+				else
+				{
+					val = rand_float<T>(min, max);
+				}
+			}
+		}
+
+	private:
+		Derived& derived()
+		{
+			return static_cast<Derived&>(*this);
+		}
+	};
+
+	// xoshiro256** by Blackman and Vigna. 32 bytes of state, period 2^256 - 1.
+	class c_xoshiro256 : public c_rand_engine<c_xoshiro256>
+	{
+	public:
+		using state_t = std::array<std::uint64_t, 4>;
+
+		// Jumps 2^128 steps ahead.
+		static constexpr state_t jump_table = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+		// Jumps 2^192 steps ahead.
+		static constexpr state_t long_jump_table = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+
+		// Seeds from the device.
+		c_xoshiro256() : c_xoshiro256(random_seed()) {}
+
+		explicit constexpr c_xoshiro256(std::uint64_t seed) : m_state()
+		{
+			for (std::uint64_t& word : m_state)
+			{
+				word = splitmix64(seed);
+			}
+		}
+
+		static constexpr std::uint64_t step(state_t& s)
+		{
+			std::uint64_t const result = std::rotl(s[1] * 5, 7) * 9;
+			std::uint64_t const t = s[1] << 17;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = std::rotl(s[3], 45);
+			return result;
+		}
+
+		static constexpr void jump(state_t& s, state_t const& table)
+		{
+			state_t acc = {};
+			for (std::uint64_t word : table)
+			{
+				for (int bit = 0; bit < 64; ++bit)
+				{
+					if (word & (std::uint64_t(1) << bit))
+					{
+						for (std::size_t i = 0; i < acc.size(); ++i)
+						{
+							acc[i] ^= s[i];
+						}
+					}
+					step(s);
+				}
+			}
+			s = acc;
+		}
+
+		constexpr std::uint64_t next_u64()
+		{
+			return step(m_state);
+		}
+
+		constexpr std::uint32_t next_u32()
+		{
+			return static_cast<std::uint32_t>(next_u64() >> 32);
+		}
+
+		constexpr void jump()
+		{
+			jump(m_state, jump_table);
+		}
+
+		constexpr void long_jump()
+		{
+			jump(m_state, long_jump_table);
+		}
+
+		// Returns an engine continuing the current sequence and moves this one 2^192 steps ahead.
+		// Calling this once per worker gives each worker a non-overlapping deterministic stream.
+		constexpr c_xoshiro256 split()
+		{
+			c_xoshiro256 stream = *this;
+			long_jump();
+			return stream;
+		}
+
+		constexpr state_t const& state() const
+		{
+			return m_state;
+		}
+
+	private:
+		state_t m_state;
+	};
+
+	// PCG32 (XSH RR) by O'Neill. 16 bytes of state. Engines with the same seed and different
+	// stream ids produce distinct sequences; advance() skips ahead in O(log delta).
+	class c_pcg32 : public c_rand_engine<c_pcg32>
+	{
+	public:
+		static constexpr std::uint64_t multiplier = 6364136223846793005ull;
+
+		// Seeds from the device.
+		c_pcg32() : c_pcg32(random_seed()) {}
+
+		explicit constexpr c_pcg32(std::uint64_t seed, std::uint64_t stream = 0)
+			: m_state(0)
+			, m_inc((stream << 1) | 1)
+		{
+			next_u32();
+			m_state += seed;
+			next_u32();
+		}
+
+		constexpr std::uint32_t next_u32()
+		{
+			std::uint64_t const old = m_state;
+			m_state = old * multiplier + m_inc;
+			std::uint32_t const xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+			return std::rotr(xorshifted, static_cast<int>(old >> 59));
+		}
+
+		constexpr std::uint64_t next_u64()
+		{
+			std::uint64_t const hi = next_u32();
+			return (hi << 32) | next_u32();
+		}
+
+		constexpr void advance(std::uint64_t delta)
+		{
+			std::uint64_t cur_mult = multiplier;
+			std::uint64_t cur_plus = m_inc;
+			std::uint64_t acc_mult = 1;
+			std::uint64_t acc_plus = 0;
+			while (delta > 0)
+			{
+				if (delta & 1)
+				{
+					acc_mult *= cur_mult;
+					acc_plus = acc_plus * cur_mult + cur_plus;
+				}
+				cur_plus = (cur_mult + 1) * cur_plus;
+				cur_mult *= cur_mult;
+				delta >>= 1;
+			}
+			m_state = acc_mult * m_state + acc_plus;
+		}
+
+	private:
+		std::uint64_t m_state;
+		std::uint64_t m_inc;
+	};
+
+	// Four interleaved xoshiro256** lanes, each 2^128 steps apart, for bulk generation. The fill
+	// overloads use AVX2 when the library is built with it and produce the same output either way.
+	class c_xoshiro256x4 : public c_rand_engine<c_xoshiro256x4>
+	{
+	public:
+		static constexpr std::size_t lanes = 4;
+
+		// Seeds from the device.
+		c_xoshiro256x4() : c_xoshiro256x4(c_xoshiro256(random_seed())) {}
+		explicit c_xoshiro256x4(std::uint64_t seed) : c_xoshiro256x4(c_xoshiro256(seed)) {}
+		explicit c_xoshiro256x4(c_xoshiro256 base);
+
+		// Writes one value per lane.
+		void next4(std::uint64_t* out);
+		std::uint64_t next_u64();
+
+		std::uint32_t next_u32()
+		{
+			return static_cast<std::uint32_t>(next_u64() >> 32);
+		}
+
+		void long_jump();
+
+		// Returns an engine continuing the current sequence and moves every lane 2^192 steps ahead.
+		c_xoshiro256x4 split();
+
+		using c_rand_engine<c_xoshiro256x4>::fill;
+		void fill(std::span<std::uint32_t> out, std::uint32_t min, std::uint32_t max);
+		void fill(std::span<std::int32_t> out, std::int32_t min, std::int32_t max);
+		void fill(std::span<float> out, float min, float max);
+
+	private:
+		void fill_bounded(std::uint32_t* out, std::size_t count, std::uint32_t base, std::uint32_t range);
+
+		// Structure of arrays: m_state[word][lane].
+		alignas(32) std::uint64_t m_state[4][lanes];
+		alignas(32) std::uint64_t m_buffer[lanes];
+		std::size_t m_buffered;
+	};
+}
@@ -0,0 +1,168 @@
+#include "sprite_batch.h"
+#include <array>
+
+namespace tt
+{
+	c_sprite_batch::c_sprite_batch()
+		: m_last_texture(nullptr)
+		, m_last_texture_id(0)
+		, m_vertices(sf::Quads)
+	{
+	}
+
+	void c_sprite_batch::clear()
+	{
+		m_sprites.clear();
+		m_keys.clear();
+		m_texture_ids.clear();
+		m_textures.clear();
+		m_last_texture = nullptr;
+		m_last_texture_id = 0;
+	}
+
+	bool c_sprite_batch::add(s_sprite const& sprite)
+	{
+		std::uint32_t const texture = texture_id(sprite.texture);
+		if (texture == max_textures)
+		{
+			return false;
+		}
+		m_sprites.push_back(sprite);
+		m_keys.push_back(static_cast<std::uint32_t>(sprite.layer) << 16 | texture);
+		return true;
+	}
+
+	void c_sprite_batch::build()
+	{
+		sort();
+
+		// Runs come from the sorted keys; the low 16 bits are the texture id.
+		m_runs.clear();
+		for (std::size_t i = 0; i < m_sorted_keys.size(); ++i)
+		{
+			sf::Texture const* texture = m_textures[m_sorted_keys[i] & 0xffff];
+			if (m_runs.empty() || m_runs.back().texture != texture)
+			{
+				m_runs.push_back({ texture, static_cast<std::uint32_t>(i * 4), 0 });
+			}
+			m_runs.back().vertex_count += 4;
+		}
+
+		// Sprites are read in submission order and their quads scattered to their sorted slots, which
+		// is cheaper than gathering sprites in sorted order.
+		m_vertices.resize(m_sprites.size() * 4);
+		for (std::size_t index = 0; index < m_sprites.size(); ++index)
+		{
+			s_sprite const& sprite = m_sprites[index];
+
+			// Corners relative to the origin, scaled, then rotated once per sprite by the angle's direction.
+			c_vec2f const dir = sprite.angle.dir();
+			float const left = -sprite.origin.x() * sprite.scale.x();
+			float const top = -sprite.origin.y() * sprite.scale.y();
+			float const right = (static_cast<float>(sprite.rect.width) - sprite.origin.x()) * sprite.scale.x();
+			float const bottom = (static_cast<float>(sprite.rect.height) - sprite.origin.y()) * sprite.scale.y();
+			float const corners[4][2] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+
+			float const u0 = static_cast<float>(sprite.rect.left);
+			float const v0 = static_cast<float>(sprite.rect.top);
+			float const u1 = u0 + static_cast<float>(sprite.rect.width);
+			float const v1 = v0 + static_cast<float>(sprite.rect.height);
+			float const uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+
+			sf::Vertex* quad = &m_vertices[static_cast<std::size_t>(m_rank[index]) * 4];
+			for (int i = 0; i < 4; ++i)
+			{
+				quad[i].position = { dir.x() * corners[i][0] - dir.y() * corners[i][1] + sprite.position.x(), dir.y() * corners[i][0] + dir.x() * corners[i][1] + sprite.position.y() };
+				quad[i].color = sprite.color;
+				quad[i].texCoords = { uvs[i][0], uvs[i][1] };
+			}
+		}
+	}
+
+	void c_sprite_batch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		for (s_run const& run : m_runs)
+		{
+			states.texture = run.texture;
+			target.draw(&m_vertices[run.first_vertex], run.vertex_count, sf::Quads, states);
+		}
+	}
+
+	std::uint32_t c_sprite_batch::texture_id(sf::Texture const* texture)
+	{
+		// Consecutive sprites usually share a texture.
+		if (texture == m_last_texture && !m_texture_ids.empty())
+		{
+			return m_last_texture_id;
+		}
+		auto it = m_texture_ids.find(texture);
+		if (it == m_texture_ids.end())
+		{
+			if (m_textures.size() == max_textures)
+			{
+				return max_textures;
+			}
+			it = m_texture_ids.emplace(texture, static_cast<std::uint32_t>(m_textures.size())).first;
+			m_textures.push_back(texture);
+		}
+		m_last_texture = texture;
+		m_last_texture_id = it->second;
+		return it->second;
+	}
+
+	// LSD radix sort of sprite indices by key, 8 bits per pass. Passes where every key has the same
+	// digit are skipped, which is most of them when few layers and textures are in use.
+	void c_sprite_batch::sort()
+	{
+		std::size_t const count = m_sprites.size();
+		m_sorted_keys.assign(m_keys.begin(), m_keys.end());
+		m_order.resize(count);
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			m_order[i] = i;
+		}
+
+		std::array<std::array<std::uint32_t, 256>, 4> histograms = {};
+		for (std::uint32_t key : m_keys)
+		{
+			for (int pass = 0; pass < 4; ++pass)
+			{
+				++histograms[pass][(key >> (pass * 8)) & 0xff];
+			}
+		}
+
+		m_scratch_keys.resize(count);
+		m_scratch_order.resize(count);
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			std::array<std::uint32_t, 256>& histogram = histograms[pass];
+			int const shift = pass * 8;
+			if (count == 0 || histogram[(m_sorted_keys[0] >> shift) & 0xff] == count)
+			{
+				continue;
+			}
+
+			std::uint32_t offset = 0;
+			for (std::uint32_t& bucket : histogram)
+			{
+				std::uint32_t const size = bucket;
+				bucket = offset;
+				offset += size;
+			}
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::uint32_t const slot = histogram[(m_sorted_keys[i] >> shift) & 0xff]++;
+				m_scratch_keys[slot] = m_sorted_keys[i];
+				m_scratch_order[slot] = m_order[i];
+			}
+			m_sorted_keys.swap(m_scratch_keys);
+			m_order.swap(m_scratch_order);
+		}
+
+		m_rank.resize(count);
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			m_rank[m_order[i]] = i;
+		}
+	}
+}
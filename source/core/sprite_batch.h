@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/math.h"
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace tt
+{
+	struct s_sprite
+	{
+		sf::Texture const* texture = nullptr;
+		// Source rectangle in the texture, in pixels.
+		sf::IntRect rect;
+		// Where the origin lands, and the origin relative to the top-left of rect before scaling.
+		c_vec2f position;
+		c_vec2f origin;
+		c_angle angle;
+		c_vec2f scale = { 1.0f, 1.0f };
+		sf::Color color = sf::Color::White;
+		// Lower layers are drawn first.
+		std::uint16_t layer = 0;
+	};
+
+	// Collects sprites for a frame and draws them with one draw call per run of sprites sharing a
+	// texture. Sprites are radix sorted by (layer, texture); within a layer, sprites with the same
+	// texture keep their submission order, but sprites with different textures may be reordered.
+	// build() only touches CPU memory, so it runs without a window.
+	class c_sprite_batch
+	{
+	public:
+		struct s_run
+		{
+			sf::Texture const* texture;
+			std::uint32_t first_vertex;
+			std::uint32_t vertex_count;
+		};
+
+		// Texture ids share the sort key with the layer, 16 bits each.
+		static constexpr std::uint32_t max_textures = 1u << 16;
+
+		c_sprite_batch();
+
+		// Keeps allocations for the next frame.
+		void clear();
+		// At most max_textures distinct textures per batch. Returns false and drops the sprite when it
+		// would need one more; draw what is batched and clear() to make room.
+		bool add(s_sprite const& sprite);
+
+		// Sorts the sprites and builds four sf::Quads vertices per sprite.
+		void build();
+		sf::VertexArray const& vertices() const { return m_vertices; }
+		std::span<s_run const> runs() const { return m_runs; }
+
+		// Draws the result of the last build().
+		void draw(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default) const;
+
+	private:
+		// max_textures when the texture would not fit in the key.
+		std::uint32_t texture_id(sf::Texture const* texture);
+		void sort();
+
+		std::vector<s_sprite> m_sprites;
+		std::vector<std::uint32_t> m_keys;
+		std::vector<std::uint32_t> m_sorted_keys;
+		std::vector<std::uint32_t> m_order;
+		std::vector<std::uint32_t> m_rank;
+		std::vector<std::uint32_t> m_scratch_keys;
+		std::vector<std::uint32_t> m_scratch_order;
+		std::unordered_map<sf::Texture const*, std::uint32_t> m_texture_ids;
+		std::vector<sf::Texture const*> m_textures;
+		sf::Texture const* m_last_texture;
+		std::uint32_t m_last_texture_id;
+		sf::VertexArray m_vertices;
+		std::vector<s_run> m_runs;
+	};
+}
@@ -0,0 +1,171 @@
+#include "transform.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tt
+{
+	c_transform2 c_transform2::from(c_vec2f position, c_angle angle, c_vec2f scale)
+	{
+		float const rad = static_cast<float>(angle.angle_rad());
+		float const cos_val = std::cos(rad);
+		float const sin_val = std::sin(rad);
+		return { cos_val * scale.x(), sin_val * scale.x(), -sin_val * scale.y(), cos_val * scale.y(), position.x(), position.y() };
+	}
+
+	void c_transform2::apply(std::span<c_vec2f const> in, std::span<c_vec2f> out) const
+	{
+		std::size_t const count = std::min(in.size(), out.size());
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			out[i] = *this * in[i];
+		}
+	}
+
+	std::uint32_t c_transform_hierarchy::add(std::uint32_t parent, c_vec2f position, c_angle angle, c_vec2f scale)
+	{
+		std::uint32_t const node = count();
+		m_parents.push_back(parent);
+		m_first_child.push_back(no_parent);
+		m_next_sibling.push_back(no_parent);
+		if (parent != no_parent)
+		{
+			m_next_sibling[node] = m_first_child[parent];
+			m_first_child[parent] = node;
+		}
+		m_local.push_back(c_transform2::from(position, angle, scale));
+		m_world.push_back({});
+		m_dirty.push_back(0);
+		mark_dirty(node);
+		return node;
+	}
+
+	void c_transform_hierarchy::set_local(std::uint32_t node, c_vec2f position, c_angle angle, c_vec2f scale)
+	{
+		set_local(node, c_transform2::from(position, angle, scale));
+	}
+
+	void c_transform_hierarchy::set_local(std::uint32_t node, c_transform2 const& local)
+	{
+		m_local[node] = local;
+		mark_dirty(node);
+	}
+
+	// m_dirty is 1 for marked nodes and 2 once a node has been collected, so a subtree reached from
+	// two dirty roots is only walked once.
+	void c_transform_hierarchy::update()
+	{
+		if (m_dirty_roots.empty())
+		{
+			return;
+		}
+		m_dirty_nodes.clear();
+		for (std::uint32_t root : m_dirty_roots)
+		{
+			m_stack.push_back(root);
+			while (!m_stack.empty())
+			{
+				std::uint32_t const node = m_stack.back();
+				m_stack.pop_back();
+				if (m_dirty[node] == 2)
+				{
+					continue;
+				}
+				m_dirty[node] = 2;
+				m_dirty_nodes.push_back(node);
+				for (std::uint32_t child = m_first_child[node]; child != no_parent; child = m_next_sibling[child])
+				{
+					m_stack.push_back(child);
+				}
+			}
+		}
+
+		// Parents have lower indices than their children, so ascending order computes every parent
+		// before its children.
+		std::sort(m_dirty_nodes.begin(), m_dirty_nodes.end());
+		recompute(m_dirty_nodes);
+		for (std::uint32_t node : m_dirty_nodes)
+		{
+			m_dirty[node] = 0;
+		}
+		m_dirty_roots.clear();
+	}
+
+	void c_transform_hierarchy::update_all()
+	{
+		m_dirty_nodes.resize(count());
+		for (std::uint32_t node = 0; node < count(); ++node)
+		{
+			m_dirty_nodes[node] = node;
+		}
+		recompute(m_dirty_nodes);
+		std::fill(m_dirty.begin(), m_dirty.end(), 0);
+		m_dirty_roots.clear();
+	}
+
+	void c_transform_hierarchy::mark_dirty(std::uint32_t node)
+	{
+		if (m_dirty[node] == 0)
+		{
+			m_dirty[node] = 1;
+			m_dirty_roots.push_back(node);
+		}
+	}
+
+	void c_transform_hierarchy::recompute(std::span<std::uint32_t const> nodes)
+	{
+		// Nodes are composed in groups. When no node in a group is the parent of another, the group is
+		// gathered into structure-of-arrays temporaries and composed in a loop the compiler vectorizes.
+		constexpr std::size_t width = 8;
+		std::size_t i = 0;
+		for (; nodes.size() - i >= width; i += width)
+		{
+			std::uint32_t const* group = nodes.data() + i;
+			bool independent = true;
+			for (std::size_t k = 0; k < width; ++k)
+			{
+				std::uint32_t const parent = m_parents[group[k]];
+				independent &= parent == no_parent || parent < group[0];
+			}
+			if (!independent)
+			{
+				for (std::size_t k = 0; k < width; ++k)
+				{
+					std::uint32_t const parent = m_parents[group[k]];
+					m_world[group[k]] = parent == no_parent ? m_local[group[k]] : m_world[parent] * m_local[group[k]];
+				}
+				continue;
+			}
+
+			float pa[width], pb[width], pc[width], pd[width], ptx[width], pty[width];
+			float la[width], lb[width], lc[width], ld[width], ltx[width], lty[width];
+			for (std::size_t k = 0; k < width; ++k)
+			{
+				std::uint32_t const parent = m_parents[group[k]];
+				c_transform2 const p = parent == no_parent ? c_transform2() : m_world[parent];
+				c_transform2 const& l = m_local[group[k]];
+				pa[k] = p.a(); pb[k] = p.b(); pc[k] = p.c(); pd[k] = p.d(); ptx[k] = p.translation().x(); pty[k] = p.translation().y();
+				la[k] = l.a(); lb[k] = l.b(); lc[k] = l.c(); ld[k] = l.d(); ltx[k] = l.translation().x(); lty[k] = l.translation().y();
+			}
+			float oa[width], ob[width], oc[width], od[width], otx[width], oty[width];
+			for (std::size_t k = 0; k < width; ++k)
+			{
+				oa[k] = pa[k] * la[k] + pc[k] * lb[k];
+				ob[k] = pb[k] * la[k] + pd[k] * lb[k];
+				oc[k] = pa[k] * lc[k] + pc[k] * ld[k];
+				od[k] = pb[k] * lc[k] + pd[k] * ld[k];
+				otx[k] = pa[k] * ltx[k] + pc[k] * lty[k] + ptx[k];
+				oty[k] = pb[k] * ltx[k] + pd[k] * lty[k] + pty[k];
+			}
+			for (std::size_t k = 0; k < width; ++k)
+			{
+				m_world[group[k]] = { oa[k], ob[k], oc[k], od[k], otx[k], oty[k] };
+			}
+		}
+		for (; i < nodes.size(); ++i)
+		{
+			std::uint32_t const node = nodes[i];
+			std::uint32_t const parent = m_parents[node];
+			m_world[node] = parent == no_parent ? m_local[node] : m_world[parent] * m_local[node];
+		}
+	}
+}
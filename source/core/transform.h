@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/math.h"
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace tt
+{
+	// 2D affine transform stored as the 3x2 matrix
+	//   | a c tx |
+	//   | b d ty |
+	// so a point maps to (a x + c y + tx, b x + d y + ty).
+	class c_transform2
+	{
+	public:
+		constexpr c_transform2() : m_a(1), m_b(0), m_c(0), m_d(1), m_tx(0), m_ty(0) {}
+		constexpr c_transform2(float a, float b, float c, float d, float tx, float ty) : m_a(a), m_b(b), m_c(c), m_d(d), m_tx(tx), m_ty(ty) {}
+
+		// Scale, then rotate, then translate.
+		static c_transform2 from(c_vec2f position, c_angle angle, c_vec2f scale = { 1.0f, 1.0f });
+
+		constexpr float a() const { return m_a; }
+		constexpr float b() const { return m_b; }
+		constexpr float c() const { return m_c; }
+		constexpr float d() const { return m_d; }
+		constexpr c_vec2f translation() const { return { m_tx, m_ty }; }
+
+		// Returns the transform applying other first, then this.
+		constexpr c_transform2 operator*(c_transform2 const& other) const
+		{
+			return {
+				m_a * other.m_a + m_c * other.m_b,
+				m_b * other.m_a + m_d * other.m_b,
+				m_a * other.m_c + m_c * other.m_d,
+				m_b * other.m_c + m_d * other.m_d,
+				m_a * other.m_tx + m_c * other.m_ty + m_tx,
+				m_b * other.m_tx + m_d * other.m_ty + m_ty,
+			};
+		}
+
+		constexpr c_vec2f operator*(c_vec2f point) const
+		{
+			return { m_a * point.x() + m_c * point.y() + m_tx, m_b * point.x() + m_d * point.y() + m_ty };
+		}
+
+		// Returns the identity when the transform is not invertible.
+		constexpr c_transform2 inverse() const
+		{
+			float const det = m_a * m_d - m_b * m_c;
+			if (det == 0.0f)
+			{
+				return {};
+			}
+			float const inv = 1.0f / det;
+			return {
+				m_d * inv,
+				-m_b * inv,
+				-m_c * inv,
+				m_a * inv,
+				(m_c * m_ty - m_d * m_tx) * inv,
+				(m_b * m_tx - m_a * m_ty) * inv,
+			};
+		}
+
+		// Transforms min(in.size(), out.size()) points. in and out may be the same span.
+		void apply(std::span<c_vec2f const> in, std::span<c_vec2f> out) const;
+
+	private:
+		float m_a;
+		float m_b;
+		float m_c;
+		float m_d;
+		float m_tx;
+		float m_ty;
+	};
+
+	// Flat transform hierarchy. Nodes are appended after their parent, so a single forward pass sees
+	// every parent before its children. update() only visits nodes whose local transform changed and
+	// their descendants, found through per-node child lists, so its cost does not depend on the size
+	// of the rest of the hierarchy.
+	class c_transform_hierarchy
+	{
+	public:
+		static constexpr std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+
+		// parent must be no_parent or an existing node.
+		std::uint32_t add(std::uint32_t parent, c_vec2f position, c_angle angle, c_vec2f scale = { 1.0f, 1.0f });
+		void set_local(std::uint32_t node, c_vec2f position, c_angle angle, c_vec2f scale = { 1.0f, 1.0f });
+		void set_local(std::uint32_t node, c_transform2 const& local);
+
+		void update();
+		// Recomputes every node regardless of dirty flags.
+		void update_all();
+
+		std::uint32_t count() const { return static_cast<std::uint32_t>(m_parents.size()); }
+		std::uint32_t parent(std::uint32_t node) const { return m_parents[node]; }
+		c_transform2 const& local(std::uint32_t node) const { return m_local[node]; }
+		// Valid after update().
+		c_transform2 const& world(std::uint32_t node) const { return m_world[node]; }
+
+	private:
+		void mark_dirty(std::uint32_t node);
+		void recompute(std::span<std::uint32_t const> nodes);
+
+		std::vector<std::uint32_t> m_parents;
+		std::vector<std::uint32_t> m_first_child;
+		std::vector<std::uint32_t> m_next_sibling;
+		std::vector<c_transform2> m_local;
+		std::vector<c_transform2> m_world;
+		std::vector<std::uint8_t> m_dirty;
+		// Nodes marked since the last update; descendants are found from these.
+		std::vector<std::uint32_t> m_dirty_roots;
+		std::vector<std::uint32_t> m_dirty_nodes;
+		std::vector<std::uint32_t> m_stack;
+	};
+}
@@ -0,0 +1,91 @@
+#include "core/archive.h"
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	std::vector<char> read_file(char const* path)
+	{
+		std::ifstream in(path, std::ios::binary);
+		return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+	}
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Fixed vectors with the same elements but different garbage in their unused capacity and
+	// padding give identical files.
+	std::vector<std::byte> storage[2];
+	for (std::uint32_t i = 0; i < 2; ++i)
+	{
+		using vector = c_fixed_vector<std::uint16_t, 5>;
+		storage[i].resize(sizeof(vector) * 2);
+		std::memset(storage[i].data(), i == 0 ? 0x00 : 0xab, storage[i].size());
+		vector* const vectors = reinterpret_cast<vector*>(storage[i].data());
+		for (std::uint32_t v = 0; v < 2; ++v)
+		{
+			// Constructing a vector only sets the count; the old bytes stay in its capacity.
+			new (&vectors[v]) vector();
+			vectors[v].append(std::uint16_t(7 + v));
+		}
+		if (i == 1)
+		{
+			vectors[1].append(std::uint16_t(3));
+			vectors[1].remove_at_ordered(1);
+		}
+
+		c_archive_writer writer;
+		failures += check(writer.open(i == 0 ? "archive_test_a.tta" : "archive_test_b.tta"), "open");
+		failures += check(writer.write<vector>("vectors"_h, { vectors, 2 }), "write");
+		failures += check(writer.finish(), "finish");
+	}
+	failures += check(read_file("archive_test_a.tta") == read_file("archive_test_b.tta"), "fixed vector sections are deterministic");
+
+	c_archive_reader reader;
+	failures += check(reader.open("archive_test_b.tta"), "reopen");
+	auto const vectors = reader.get<c_fixed_vector<std::uint16_t, 5>>("vectors"_h);
+	failures += check(vectors.size() == 2 && vectors[1].count() == 1 && vectors[1][0] == 8, "fixed vectors read back");
+	reader.close();
+
+	// Opening a second archive finishes the first instead of dropping its table.
+	{
+		c_archive_writer writer;
+		std::uint32_t const values[] = { 1, 2, 3 };
+		writer.open("archive_test_a.tta");
+		writer.write<std::uint32_t>("values"_h, values);
+		failures += check(writer.open("archive_test_b.tta"), "open while open");
+	}
+	failures += check(reader.open("archive_test_a.tta") && reader.get<std::uint32_t>("values"_h).size() == 3, "first archive was finished");
+	reader.close();
+	failures += check(reader.open("archive_test_b.tta") && reader.sections().empty(), "second archive is empty");
+	reader.close();
+
+#if defined(__linux__)
+	// A previous archive that cannot be finished fails the next open(), which then leaves the
+	// writer closed so a later open() starts cleanly.
+	{
+		c_archive_writer writer;
+		std::vector<std::uint32_t> const values(4096, 9);
+		if (writer.open("/dev/full"))
+		{
+			writer.write<std::uint32_t>("values"_h, values);
+			failures += check(!writer.open("archive_test_a.tta"), "open fails when the previous archive could not be finished");
+			failures += check(writer.open("archive_test_a.tta") && writer.finish(), "open after a failed finish");
+		}
+	}
+#endif
+
+	std::remove("archive_test_a.tta");
+	std::remove("archive_test_b.tta");
+	return failures == 0 ? 0 : 1;
+}
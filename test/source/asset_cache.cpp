@@ -0,0 +1,71 @@
+#include "core/asset_cache.h"
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	// Assets are the file's first byte; empty files fail to decode.
+	std::shared_ptr<void const> decode(std::span<std::byte const> data, std::size_t& size)
+	{
+		if (data.empty())
+		{
+			return nullptr;
+		}
+		size = 1;
+		return std::make_shared<std::byte>(data[0]);
+	}
+
+	void write_file(char const* path, char value)
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.put(value);
+	}
+}
+
+int main()
+{
+	int failures = 0;
+	char const* const path = "asset_cache_test.bin";
+	std::remove(path);
+
+	c_asset_cache cache(decode, 1024, 2);
+
+	// A failed load is kept while handles hold it, but requesting it again retries instead of
+	// counting as a hit, and the old handles see the new result.
+	c_asset_handle failed = cache.request("asset"_h, path);
+	cache.wait(failed);
+	failures += check(failed.state() == e_asset_state::failed && failed.get<std::byte>() == nullptr, "missing file fails");
+
+	write_file(path, 42);
+	c_asset_handle retried = cache.request("asset"_h, path);
+	failures += check(cache.stats().misses == 2 && cache.stats().hits == 0, "requesting a failed asset is a miss");
+	failures += check(failed.state() == e_asset_state::loading, "old handles follow the retry");
+	cache.wait(retried);
+	failures += check(retried.ready() && failed.ready() && *retried.get<std::byte>() == std::byte{ 42 }, "retry loads the asset");
+
+	// Ready assets are hits, and request_now retries failed assets the same way.
+	c_asset_handle hit = cache.request("asset"_h, path);
+	failures += check(cache.stats().hits == 1 && hit.get<std::byte>() == retried.get<std::byte>(), "loaded asset is a hit");
+
+	std::remove(path);
+	c_asset_handle other = cache.request_now("other"_h, path);
+	failures += check(other.state() == e_asset_state::failed, "request_now on a missing file fails");
+	write_file(path, 7);
+	c_asset_handle other_retried = cache.request_now("other"_h, path);
+	failures += check(other_retried.ready() && other.ready() && *other.get<std::byte>() == std::byte{ 7 }, "request_now retries a failed asset");
+	failures += check(cache.stats().misses == 4, "both request_now calls are misses");
+
+	other.reset();
+	other_retried.reset();
+	hit.reset();
+	retried.reset();
+	failed.reset();
+	std::remove(path);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include "core/atlas.h"
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	bool exists(char const* path)
+	{
+		return std::ifstream(path).good();
+	}
+}
+
+int main()
+{
+	int failures = 0;
+	char const* const path = "atlas_test.tta";
+	std::remove(path);
+
+	s_atlas_input const inputs[] = {
+		{ "a"_h, { 30, 20 } },
+		{ "b"_h, { 10, 40 } },
+		{ "c"_h, { 0, 5 } },
+		{ "d"_h, { 64, 64 } },
+	};
+	c_vec2i const page_size = { 64, 64 };
+
+	// Nothing to save before a layout exists, or after packing fails.
+	c_atlas atlas;
+	failures += check(!atlas.save(path) && !exists(path), "save before pack fails");
+	s_atlas_input const too_large[] = { { "e"_h, { 65, 1 } } };
+	failures += check(!atlas.pack(too_large, page_size) && !atlas.save(path) && !exists(path), "save after a failed pack fails");
+
+	failures += check(atlas.pack(inputs, page_size) && atlas.save(path), "save after pack");
+	failures += check(atlas.pages().size() == 2 && atlas.find("c"_h) != nullptr, "packed layout");
+
+	// The saved layout loads back, and only for the same inputs and settings.
+	c_atlas loaded;
+	failures += check(loaded.load(path, inputs, page_size), "load");
+	bool same = loaded.pages().size() == atlas.pages().size() && loaded.entries().size() == atlas.entries().size();
+	for (std::size_t i = 0; same && i < atlas.entries().size(); ++i)
+	{
+		s_atlas_entry const& a = atlas.entries()[i];
+		s_atlas_entry const& b = loaded.entries()[i];
+		same = a.name == b.name && a.page == b.page && a.left == b.left && a.top == b.top && a.width == b.width && a.height == b.height;
+	}
+	failures += check(same, "loaded layout matches");
+	failures += check(!c_atlas().load(path, inputs, page_size, 2), "load with other settings fails");
+
+	// A loaded layout can be saved again.
+	std::remove(path);
+	failures += check(loaded.save(path) && c_atlas().load(path, inputs, page_size), "save after load");
+
+	std::remove(path);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include "core/broadphase.h"
+#include "core/rand.h"
+#include "test.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	using pair_t = std::pair<c_broadphase::id_t, c_broadphase::id_t>;
+
+	struct s_box
+	{
+		c_vec2i center;
+		c_vec2i extents;
+		bool live;
+	};
+
+	// Mostly boxes around the cell size, some much larger, some degenerate, with odd extents so
+	// halving rounds.
+	s_box random_box(c_xoshiro256& rand)
+	{
+		std::int32_t const max_extent = rand.rand_int<std::uint32_t>(0, 9) == 0 ? 120 : 24;
+		return {
+			{ rand.rand_int<std::int32_t>(-200, 200), rand.rand_int<std::int32_t>(-200, 200) },
+			{ rand.rand_int<std::int32_t>(0, max_extent), rand.rand_int<std::int32_t>(0, max_extent) },
+			true,
+		};
+	}
+
+	std::vector<pair_t> brute_force_pairs(std::vector<s_box> const& boxes)
+	{
+		std::vector<pair_t> out;
+		for (std::size_t a = 0; a < boxes.size(); ++a)
+		{
+			for (std::size_t b = a + 1; b < boxes.size(); ++b)
+			{
+				if (boxes[a].live && boxes[b].live && overlaps(boxes[a].center, boxes[a].extents, boxes[b].center, boxes[b].extents))
+				{
+					out.emplace_back(static_cast<c_broadphase::id_t>(a), static_cast<c_broadphase::id_t>(b));
+				}
+			}
+		}
+		return out;
+	}
+}
+
+int main()
+{
+#if defined(__AVX2__)
+	if (!avx2_supported())
+	{
+		return skipped;
+	}
+#endif
+
+	int failures = 0;
+	c_xoshiro256 rand(0xb0c5);
+
+	// The batch narrow phase matches the single-pair test for every length, including the tails
+	// left over after groups of four.
+	{
+		bool same = true;
+		for (std::uint32_t round = 0; round < 500; ++round)
+		{
+			s_box const box = random_box(rand);
+			std::size_t const count = rand.rand_int<std::size_t>(0, 19);
+			std::vector<c_vec2i> centers(count);
+			std::vector<c_vec2i> extents(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				s_box const other = random_box(rand);
+				// Negative extents never overlap in either path.
+				centers[i] = other.center;
+				extents[i] = i % 7 == 6 ? c_vec2i(-other.extents.x(), other.extents.y()) : other.extents;
+			}
+			std::vector<std::uint32_t> hits(count);
+			hits.resize(overlaps(box.center, box.extents, centers, extents, hits.data()));
+			std::vector<std::uint32_t> expected;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (overlaps(box.center, box.extents, centers[i], extents[i]))
+				{
+					expected.push_back(static_cast<std::uint32_t>(i));
+				}
+			}
+			same = same && hits == expected;
+		}
+		failures += check(same, "batch overlaps matches the single-pair test");
+	}
+
+	// Pairs and queries match an O(n^2) check as boxes are added, moved within and across cells,
+	// resized, removed and their ids reused. Each pair is reported exactly once.
+	c_broadphase broadphase(16);
+	std::vector<s_box> boxes;
+	for (std::uint32_t i = 0; i < 300; ++i)
+	{
+		s_box const box = random_box(rand);
+		c_broadphase::id_t const id = broadphase.add(box.center, box.extents);
+		boxes.push_back(box);
+		failures += check(id == i, "ids are dense");
+	}
+
+	std::uint32_t pair_mismatches = 0;
+	std::uint32_t query_mismatches = 0;
+	std::size_t reported = 0;
+	std::vector<pair_t> pairs;
+	std::vector<c_broadphase::id_t> found;
+	for (std::uint32_t round = 0; round < 60; ++round)
+	{
+		for (std::size_t id = 0; id < boxes.size(); ++id)
+		{
+			s_box& box = boxes[id];
+			std::uint32_t const action = rand.rand_int<std::uint32_t>(0, 9);
+			if (!box.live)
+			{
+				if (action < 3)
+				{
+					box = random_box(rand);
+					// Freed ids are reused, most recently freed first, so track whichever id comes back.
+					c_broadphase::id_t const reused = broadphase.add(box.center, box.extents);
+					if (reused != id)
+					{
+						std::swap(box, boxes[reused]);
+						boxes[reused].live = true;
+						box.live = false;
+					}
+				}
+				continue;
+			}
+			if (action < 5)
+			{
+				// Small steps that often stay in the same cells.
+				box.center += c_vec2i(rand.rand_int<std::int32_t>(-3, 3), rand.rand_int<std::int32_t>(-3, 3));
+			}
+			else if (action < 7)
+			{
+				box.center += c_vec2i(rand.rand_int<std::int32_t>(-40, 40), rand.rand_int<std::int32_t>(-40, 40));
+			}
+			else if (action < 8)
+			{
+				box.extents = random_box(rand).extents;
+			}
+			else if (action < 9)
+			{
+				box.live = false;
+				broadphase.remove(static_cast<c_broadphase::id_t>(id));
+				continue;
+			}
+			broadphase.move(static_cast<c_broadphase::id_t>(id), box.center, box.extents);
+		}
+
+		pairs.clear();
+		broadphase.pairs(pairs);
+		std::sort(pairs.begin(), pairs.end());
+		std::vector<pair_t> const expected = brute_force_pairs(boxes);
+		if (pairs != expected)
+		{
+			if (pair_mismatches++ == 0)
+			{
+				std::printf("round %u: %zu pairs, expected %zu\n", round, pairs.size(), expected.size());
+			}
+		}
+		reported += expected.size();
+
+		for (std::uint32_t q = 0; q < 20; ++q)
+		{
+			s_box const box = random_box(rand);
+			found.clear();
+			broadphase.query(box.center, box.extents, found);
+			std::sort(found.begin(), found.end());
+			std::vector<c_broadphase::id_t> expected_found;
+			for (std::size_t id = 0; id < boxes.size(); ++id)
+			{
+				if (boxes[id].live && overlaps(box.center, box.extents, boxes[id].center, boxes[id].extents))
+				{
+					expected_found.push_back(static_cast<c_broadphase::id_t>(id));
+				}
+			}
+			query_mismatches += found == expected_found ? 0 : 1;
+		}
+	}
+	failures += check(pair_mismatches == 0, "pairs match the brute-force check once each");
+	failures += check(query_mismatches == 0, "queries match the brute-force check");
+	failures += check(reported > 1000, "the scene has enough overlaps to be meaningful");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#include "core/input.h"
+#include "test.h"
+
+using namespace tt;
+using namespace tt::test;
+
+// A reader that falls behind or reads faster than the writer publishes sees each edge exactly once.
+int main()
+{
+	c_input_publisher publisher;
+	e_action const jump = publisher.input().add(sf::Keyboard::Space, "jump"_h);
+
+	int failures = 0;
+	failures += check(!publisher.latest().pressed_this_frame(jump), "nothing pressed before the first publish");
+
+	// The press lands in the first of three frames published between reads.
+	publisher.input().on(key(sf::Event::KeyPressed, sf::Keyboard::Space));
+	publisher.publish();
+	publisher.publish();
+	publisher.publish();
+
+	c_input_snapshot const& first = publisher.latest();
+	failures += check(first.frame() == 2, "reader gets the newest frame");
+	failures += check(first[jump], "jump is held");
+	failures += check(first.pressed_this_frame(jump), "press survives skipped frames");
+
+	c_input_snapshot const& again = publisher.latest();
+	failures += check(again[jump], "jump is still held on a re-read");
+	failures += check(!again.pressed_this_frame(jump), "press is not repeated on a re-read");
+
+	publisher.publish();
+	failures += check(!publisher.latest().pressed_this_frame(jump), "press is not repeated on the next frame");
+
+	publisher.input().on(key(sf::Event::KeyReleased, sf::Keyboard::Space));
+	publisher.publish();
+	publisher.publish();
+	publisher.publish();
+	failures += check(publisher.latest().released_this_frame(jump), "release survives skipped frames");
+	failures += check(!publisher.latest().released_this_frame(jump), "release is not repeated on a re-read");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include "core/input.h"
+#include "core/input_record.h"
+#include "test.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	struct s_frame_state
+	{
+		std::uint64_t held;
+		std::uint64_t pressed;
+		std::uint64_t released;
+		c_vec2i mouse;
+
+		bool operator==(s_frame_state const& other) const
+		{
+			return held == other.held && pressed == other.pressed && released == other.released && mouse == other.mouse;
+		}
+	};
+
+	s_frame_state capture(c_input const& input)
+	{
+		s_frame_state state = { 0, 0, 0, input.mouse() };
+		for (std::uint8_t i = 0; i < c_input::max_actions; ++i)
+		{
+			e_action const action = static_cast<e_action>(i);
+			state.held |= std::uint64_t{ input[action] } << i;
+			state.pressed |= std::uint64_t{ input.pressed_this_frame(action) } << i;
+			state.released |= std::uint64_t{ input.released_this_frame(action) } << i;
+		}
+		return state;
+	}
+
+	// Both sessions start from the same bindings; later changes come from the recording.
+	void bind(c_input& input)
+	{
+		input.add(sf::Keyboard::W, "up"_h);
+		input.add(sf::Keyboard::Space, "jump"_h);
+		input.add(sf::Mouse::Left, "fire"_h);
+	}
+}
+
+// A session that starts with keys held, resets and rebinds while keys are held, and has empty
+// frames at the end replays to the same per-frame state.
+int main()
+{
+	c_input live;
+	bind(live);
+	// Before recording starts: W is held from an earlier frame, Space was pressed this frame and the
+	// mouse has moved.
+	live.on(key(sf::Event::KeyPressed, sf::Keyboard::W));
+	live.on(move(3, 4));
+	live.next_frame();
+	live.on(key(sf::Event::KeyPressed, sf::Keyboard::Space));
+	c_input_recorder recorder;
+	live.record(&recorder);
+
+	std::vector<s_frame_state> live_frames;
+	for (std::uint32_t frame = 0; frame < 12; ++frame)
+	{
+		switch (frame)
+		{
+		case 0:
+			// A repeat of the held key changes nothing.
+			live.on(key(sf::Event::KeyPressed, sf::Keyboard::W));
+			break;
+		case 1:
+			live.on(move(10, 20));
+			break;
+		case 2:
+			live.on(button(sf::Event::MouseButtonPressed, sf::Mouse::Left));
+			break;
+		case 4:
+			// W, Space and Left are still physically held; their releases arrive later.
+			live.reset();
+			break;
+		case 5:
+			live.on(key(sf::Event::KeyReleased, sf::Keyboard::W));
+			live.add(sf::Keyboard::E, "jump"_h);
+			live.add(sf::Keyboard::Q, "dash"_h);
+			live.on(key(sf::Event::KeyPressed, sf::Keyboard::E));
+			break;
+		case 7:
+			live.on(key(sf::Event::KeyPressed, sf::Keyboard::Q));
+			live.on(move(-5, 300));
+			live.reset();
+			live.on(key(sf::Event::KeyPressed, sf::Keyboard::W));
+			break;
+		case 9:
+			live.on(key(sf::Event::KeyReleased, sf::Keyboard::Space));
+			live.on(button(sf::Event::MouseButtonReleased, sf::Mouse::Left));
+			live.on(key(sf::Event::KeyReleased, sf::Keyboard::W));
+			break;
+		default:
+			break;
+		}
+		live_frames.push_back(capture(live));
+		live.next_frame();
+	}
+	live.record(nullptr);
+
+	c_input replayed;
+	bind(replayed);
+	c_input_replayer replayer(recorder.data());
+	std::vector<s_frame_state> replayed_frames;
+	while (replayer.play_frame(replayed))
+	{
+		replayed_frames.push_back(capture(replayed));
+		replayed.next_frame();
+	}
+
+	int failures = 0;
+	// The replay runs to the end of the recording, past the last event on frame 9.
+	failures += check(replayed_frames.size() == live_frames.size() && replayer.done(), "replay covers every recorded frame");
+	for (std::size_t frame = 0; frame < replayed_frames.size() && frame < live_frames.size(); ++frame)
+	{
+		if (check(replayed_frames[frame] == live_frames[frame], "replayed frame matches the live frame") != 0)
+		{
+			std::printf("  frame %zu\n", frame);
+			++failures;
+		}
+	}
+
+	// The state at attach must be in the recording, and the reset on frame 4 must have dropped the
+	// held keys in both sessions.
+	failures += check(live_frames[0].held == 3 && live_frames[0].pressed == 2 && live_frames[0].mouse == c_vec2i(3, 4), "the attach state is live");
+	failures += check(live_frames[4].held == 0, "reset clears held actions");
+	failures += check(replayed.action("dash"_h) == live.action("dash"_h), "rebinding is replayed");
+	return failures == 0 ? 0 : 1;
+}
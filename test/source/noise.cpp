@@ -0,0 +1,111 @@
+#include "core/hash.h"
+#include "core/noise.h"
+#include "test.h"
+
+#include <bit>
+#include <cstdio>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	struct s_golden
+	{
+		s_noise_settings settings;
+		// Bit patterns of noise2(settings, 10.5f, -3.25f) and noise3(settings, 10.5f, -3.25f, 7.75f).
+		std::uint32_t sample2;
+		std::uint32_t sample3;
+		// murmur_hash3 of the bit patterns of the 2D and 3D chunks below.
+		std::uint32_t chunk2;
+		std::uint32_t chunk3;
+	};
+
+	// Recorded from the scalar build. Any change to these is a change to every generated world.
+	s_golden const goldens[] = {
+		{ { e_noise::value, 1, 1.0f / 8.0f, 1, 2.0f, 0.5f }, 0xbd9c3650, 0x3e7adc68, 0x65576f49, 0xc7cc6156 },
+		{ { e_noise::perlin, 1, 1.0f / 8.0f, 1, 2.0f, 0.5f }, 0x3e908fcf, 0xbf2196d6, 0x10043b19, 0x8488c73f },
+		{ { e_noise::simplex, 1, 1.0f / 8.0f, 1, 2.0f, 0.5f }, 0x3e9e7232, 0x3ee0a8cf, 0xd89c85f9, 0xb33c8457 },
+		{ { e_noise::value, 0xdeadbeef, 1.0f / 32.0f, 5, 2.0f, 0.5f }, 0x3e8ebc43, 0x3e6bcbee, 0x9e0a4630, 0x17fc4493 },
+		{ { e_noise::perlin, 0xdeadbeef, 1.0f / 32.0f, 5, 2.0f, 0.5f }, 0x3e65409f, 0x3e804295, 0x8e189a4b, 0x5268fd25 },
+		{ { e_noise::simplex, 0xdeadbeef, 1.0f / 32.0f, 5, 1.9f, 0.6f }, 0x3ead2a97, 0x3ec66f40, 0x5951b0b9, 0x43bf5fe7 },
+	};
+
+	// Not multiples of the 8 AVX2 lanes, so chunks run both the vector loop and the scalar tail.
+	constexpr std::int32_t width = 19;
+	constexpr std::int32_t height = 5;
+	constexpr std::int32_t depth = 3;
+	constexpr float x0 = -37.25f;
+	constexpr float y0 = 12.5f;
+	constexpr float z0 = -4.0f;
+	constexpr float step = 0.75f;
+
+	std::uint32_t bits_hash(std::vector<float> const& values)
+	{
+		std::vector<std::uint32_t> bits(values.size());
+		for (std::size_t i = 0; i < values.size(); ++i)
+		{
+			bits[i] = std::bit_cast<std::uint32_t>(values[i]);
+		}
+		return murmur_hash3(reinterpret_cast<char const*>(bits.data()), static_cast<std::uint32_t>(bits.size() * sizeof(std::uint32_t)));
+	}
+}
+
+// Chunks are bit-identical to single samples, and both match values recorded from the scalar build.
+// The test/ project also builds this against AVX2 kernels, so both lane types are held to the same
+// values.
+int main()
+{
+#if defined(__AVX2__)
+	if (!avx2_supported())
+	{
+		return skipped;
+	}
+#endif
+
+	int failures = 0;
+	for (s_golden const& golden : goldens)
+	{
+		s_noise_settings const& settings = golden.settings;
+		std::vector<float> chunk2(static_cast<std::size_t>(width) * height);
+		std::vector<float> chunk3(static_cast<std::size_t>(width) * height * depth);
+		noise2(settings, chunk2, width, height, x0, y0, step);
+		noise3(settings, chunk3, width, height, depth, x0, y0, z0, step);
+
+		bool same = true;
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			for (std::int32_t col = 0; col < width; ++col)
+			{
+				float const sample = noise2(settings, x0 + static_cast<float>(col) * step, y0 + static_cast<float>(row) * step);
+				same = same && std::bit_cast<std::uint32_t>(sample) == std::bit_cast<std::uint32_t>(chunk2[static_cast<std::size_t>(row) * width + col]);
+			}
+		}
+		for (std::int32_t layer = 0; layer < depth; ++layer)
+		{
+			for (std::int32_t row = 0; row < height; ++row)
+			{
+				for (std::int32_t col = 0; col < width; ++col)
+				{
+					float const sample = noise3(settings, x0 + static_cast<float>(col) * step, y0 + static_cast<float>(row) * step, z0 + static_cast<float>(layer) * step);
+					same = same && std::bit_cast<std::uint32_t>(sample) == std::bit_cast<std::uint32_t>(chunk3[(static_cast<std::size_t>(layer) * height + row) * width + col]);
+				}
+			}
+		}
+		failures += check(same, "chunks match single samples bit for bit");
+
+		std::uint32_t const sample2 = std::bit_cast<std::uint32_t>(noise2(settings, 10.5f, -3.25f));
+		std::uint32_t const sample3 = std::bit_cast<std::uint32_t>(noise3(settings, 10.5f, -3.25f, 7.75f));
+		std::uint32_t const hash2 = bits_hash(chunk2);
+		std::uint32_t const hash3 = bits_hash(chunk3);
+		int const mismatches = check(sample2 == golden.sample2 && sample3 == golden.sample3, "single samples match the recorded values")
+			+ check(hash2 == golden.chunk2 && hash3 == golden.chunk3, "chunks match the recorded values");
+		if (mismatches != 0)
+		{
+			std::printf("  type %u seed 0x%08x: 0x%08x, 0x%08x, 0x%08x, 0x%08x\n", static_cast<unsigned>(settings.type), settings.seed, sample2, sample3, hash2, hash3);
+			failures += mismatches;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
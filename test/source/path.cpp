@@ -0,0 +1,210 @@
+#include "core/path.h"
+#include "core/rand.h"
+#include "test.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	constexpr std::uint32_t no_path = std::numeric_limits<std::uint32_t>::max();
+
+	bool can_step(c_occupancy_grid const& grid, c_vec2i from, c_vec2i to)
+	{
+		std::int32_t const dx = to.x() - from.x();
+		std::int32_t const dy = to.y() - from.y();
+		if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0) || !grid.walkable(to))
+		{
+			return false;
+		}
+		// Diagonal steps may not cut corners.
+		return dx == 0 || dy == 0 || (grid.walkable(from.x() + dx, from.y()) && grid.walkable(from.x(), from.y() + dy));
+	}
+
+	// Cost of a path with the searches' step costs, or no_path when it is not a valid walk from
+	// start to goal.
+	std::uint32_t path_cost(c_occupancy_grid const& grid, std::vector<c_vec2i> const& path, c_vec2i start, c_vec2i goal)
+	{
+		if (path.empty() || !(path.front() == start) || !(path.back() == goal) || !grid.walkable(start))
+		{
+			return no_path;
+		}
+		std::uint32_t cost = 0;
+		for (std::size_t i = 1; i < path.size(); ++i)
+		{
+			if (!can_step(grid, path[i - 1], path[i]))
+			{
+				return no_path;
+			}
+			cost += path[i - 1].x() != path[i].x() && path[i - 1].y() != path[i].y() ? 14 : 10;
+		}
+		return cost;
+	}
+
+	// Plain Dijkstra over the same moves, as the reference for the optimal cost.
+	std::uint32_t reference_cost(c_occupancy_grid const& grid, c_vec2i start, c_vec2i goal)
+	{
+		if (!grid.walkable(start) || !grid.walkable(goal))
+		{
+			return no_path;
+		}
+		std::int32_t const width = grid.width();
+		std::vector<std::uint32_t> cost(static_cast<std::size_t>(width) * grid.height(), no_path);
+		using entry = std::pair<std::uint32_t, std::int32_t>;
+		std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+		cost[static_cast<std::size_t>(start.y()) * width + start.x()] = 0;
+		open.push({ 0, start.y() * width + start.x() });
+		while (!open.empty())
+		{
+			auto const [g, node] = open.top();
+			open.pop();
+			c_vec2i const cell(node % width, node / width);
+			if (cell == goal)
+			{
+				return g;
+			}
+			if (g != cost[node])
+			{
+				continue;
+			}
+			for (std::int32_t dy = -1; dy <= 1; ++dy)
+			{
+				for (std::int32_t dx = -1; dx <= 1; ++dx)
+				{
+					c_vec2i const next(cell.x() + dx, cell.y() + dy);
+					if (!can_step(grid, cell, next))
+					{
+						continue;
+					}
+					std::uint32_t const next_g = g + (dx != 0 && dy != 0 ? 14 : 10);
+					std::size_t const next_node = static_cast<std::size_t>(next.y()) * width + next.x();
+					if (next_g < cost[next_node])
+					{
+						cost[next_node] = next_g;
+						open.push({ next_g, static_cast<std::int32_t>(next_node) });
+					}
+				}
+			}
+		}
+		return no_path;
+	}
+
+	c_occupancy_grid random_grid(c_xoshiro256& rand, std::int32_t width, std::int32_t height, std::uint32_t blocked_percent)
+	{
+		c_occupancy_grid grid(width, height);
+		for (std::int32_t y = 0; y < height; ++y)
+		{
+			for (std::int32_t x = 0; x < width; ++x)
+			{
+				grid.set_blocked(x, y, rand.rand_int<std::uint32_t>(0, 99) < blocked_percent);
+			}
+		}
+		return grid;
+	}
+
+	c_vec2i random_cell(c_xoshiro256& rand, c_occupancy_grid const& grid)
+	{
+		return { rand.rand_int<std::int32_t>(0, grid.width() - 1), rand.rand_int<std::int32_t>(0, grid.height() - 1) };
+	}
+}
+
+int main()
+{
+	int failures = 0;
+	c_xoshiro256 rand(0x5eed);
+	c_path_context context;
+	std::vector<c_vec2i> astar;
+	std::vector<c_vec2i> jps;
+
+	// Both searches find an optimal, valid path or agree there is none. Widths straddle the 64-cell
+	// words the searches scan, and the densities range from open to mostly blocked.
+	std::uint32_t found = 0;
+	std::uint32_t mismatches = 0;
+	for (std::uint32_t round = 0; round < 200; ++round)
+	{
+		std::int32_t const width = rand.rand_int<std::int32_t>(1, 150);
+		std::int32_t const height = rand.rand_int<std::int32_t>(1, 90);
+		c_occupancy_grid const grid = random_grid(rand, width, height, rand.rand_int<std::uint32_t>(0, 45));
+		for (std::uint32_t query = 0; query < 10; ++query)
+		{
+			c_vec2i const start = random_cell(rand, grid);
+			c_vec2i const goal = random_cell(rand, grid);
+			std::uint32_t const expected = reference_cost(grid, start, goal);
+			bool const astar_found = context.find(grid, start, goal, astar, e_path_search::astar);
+			bool const jps_found = context.find(grid, start, goal, jps, e_path_search::jps);
+			std::uint32_t const astar_cost = astar_found ? path_cost(grid, astar, start, goal) : no_path;
+			std::uint32_t const jps_cost = jps_found ? path_cost(grid, jps, start, goal) : no_path;
+			bool const agree = astar_found == (expected != no_path) && jps_found == astar_found && astar_cost == expected
+				&& jps_cost == expected && (astar_found || (astar.empty() && jps.empty()));
+			if (!agree)
+			{
+				if (mismatches++ < 5)
+				{
+					std::printf("round %u: %dx%d (%d, %d) -> (%d, %d) cost %u, A* %u, JPS %u\n", round, width, height, start.x(), start.y(), goal.x(), goal.y(), expected, astar_cost, jps_cost);
+				}
+			}
+			found += astar_found ? 1 : 0;
+		}
+	}
+	failures += check(mismatches == 0, "A* and JPS find valid paths of the optimal cost");
+	failures += check(found > 500 && found < 1900, "random queries cover both found and unreachable goals");
+
+	// A goal walled off by a ring, including its diagonals.
+	c_occupancy_grid walled(16, 16);
+	for (std::int32_t i = 9; i <= 13; ++i)
+	{
+		walled.set_blocked(i, 9, true);
+		walled.set_blocked(i, 13, true);
+		walled.set_blocked(9, i, true);
+		walled.set_blocked(13, i, true);
+	}
+	// The only way in is a diagonal gap, which cutting the corner would need.
+	walled.set_blocked(13, 13, false);
+	walled.set_blocked(14, 14, false);
+	for (e_path_search search : { e_path_search::astar, e_path_search::jps })
+	{
+		std::vector<c_vec2i> path = { c_vec2i(1, 1) };
+		failures += check(!context.find(walled, { 0, 0 }, { 11, 11 }, path, search) && path.empty(), "unreachable goal returns false and no path");
+		path = { c_vec2i(1, 1) };
+		failures += check(!context.find(walled, { 0, 0 }, { 9, 9 }, path, search) && path.empty(), "blocked goal returns false and no path");
+		path = { c_vec2i(1, 1) };
+		failures += check(!context.find(walled, { -1, 0 }, { 3, 3 }, path, search) && path.empty(), "start outside the grid returns false and no path");
+		path = { c_vec2i(1, 1) };
+		failures += check(!context.find(walled, { 0, 0 }, { 3, 16 }, path, search) && path.empty(), "goal outside the grid returns false and no path");
+		failures += check(context.find(walled, { 2, 2 }, { 2, 2 }, path, search) && path.size() == 1, "start equal to goal is a one-cell path");
+	}
+
+	// A batch object reused across batches, grids of different sizes and both searches gives the
+	// same results as a single context.
+	c_path_batch batch(4);
+	for (std::uint32_t round = 0; round < 6; ++round)
+	{
+		c_occupancy_grid const grid = random_grid(rand, 40 + static_cast<std::int32_t>(round) * 30, 70 - static_cast<std::int32_t>(round) * 8, 25);
+		std::vector<s_path_query> queries(round == 3 ? 1 : 37);
+		for (s_path_query& query : queries)
+		{
+			query = { random_cell(rand, grid), random_cell(rand, grid) };
+		}
+		e_path_search const search = round % 2 == 0 ? e_path_search::jps : e_path_search::astar;
+		std::vector<std::vector<c_vec2i>> paths(queries.size(), std::vector<c_vec2i>{ c_vec2i(-1, -1) });
+		batch.find(grid, queries, paths, search);
+
+		bool same = true;
+		for (std::size_t i = 0; i < queries.size(); ++i)
+		{
+			context.find(grid, queries[i].start, queries[i].goal, jps, search);
+			same = same && paths[i] == jps;
+		}
+		failures += check(same, "batch results match a single context across reused batches");
+	}
+
+	return failures == 0 ? 0 : 1;
+}
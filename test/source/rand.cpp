@@ -0,0 +1,235 @@
+#include "core/rand.h"
+#include "test.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+namespace
+{
+	// Reference lanes for c_xoshiro256x4: lane i is the base engine jumped i times.
+	std::array<c_xoshiro256, c_xoshiro256x4::lanes> reference_lanes(std::uint64_t seed)
+	{
+		std::array<c_xoshiro256, c_xoshiro256x4::lanes> lanes = { c_xoshiro256(seed), c_xoshiro256(seed), c_xoshiro256(seed), c_xoshiro256(seed) };
+		for (std::size_t lane = 1; lane < lanes.size(); ++lane)
+		{
+			lanes[lane] = lanes[lane - 1];
+			lanes[lane].jump();
+		}
+		return lanes;
+	}
+
+	// One step of every lane, viewed as eight 32-bit candidates in memory order.
+	std::array<std::uint32_t, 8> reference_block(std::array<c_xoshiro256, c_xoshiro256x4::lanes>& lanes)
+	{
+		std::array<std::uint32_t, 8> block;
+		for (std::size_t lane = 0; lane < lanes.size(); ++lane)
+		{
+			std::uint64_t const value = lanes[lane].next_u64();
+			block[lane * 2] = static_cast<std::uint32_t>(value);
+			block[lane * 2 + 1] = static_cast<std::uint32_t>(value >> 32);
+		}
+		return block;
+	}
+
+	// Scalar version of the x4 integer fill: Lemire's reduction with rejection, candidates in order.
+	std::vector<std::uint32_t> reference_fill(std::array<c_xoshiro256, c_xoshiro256x4::lanes>& lanes, std::size_t count, std::uint32_t min, std::uint32_t max)
+	{
+		std::uint32_t const range = max - min + 1;
+		std::uint32_t const threshold = range != 0 ? (0u - range) % range : 0;
+		std::vector<std::uint32_t> out;
+		while (out.size() < count)
+		{
+			for (std::uint32_t candidate : reference_block(lanes))
+			{
+				std::uint64_t const m = static_cast<std::uint64_t>(candidate) * range;
+				if (out.size() < count && (range == 0 || static_cast<std::uint32_t>(m) >= threshold))
+				{
+					out.push_back(min + (range == 0 ? candidate : static_cast<std::uint32_t>(m >> 32)));
+				}
+			}
+		}
+		return out;
+	}
+
+	std::vector<float> reference_fill(std::array<c_xoshiro256, c_xoshiro256x4::lanes>& lanes, std::size_t count, float min, float max)
+	{
+		std::vector<float> out;
+		while (out.size() < count)
+		{
+			for (std::uint32_t candidate : reference_block(lanes))
+			{
+				if (out.size() < count)
+				{
+					float const unit = static_cast<float>(candidate >> 8) * 0x1.0p-24f;
+					out.push_back(std::min(min + unit * (max - min), std::nextafter(max, min)));
+				}
+			}
+		}
+		return out;
+	}
+
+	template<class Engine>
+	bool same_sequence(Engine a, Engine b, std::uint32_t count = 16)
+	{
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			if (a.next_u64() != b.next_u64())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main()
+{
+#if defined(__AVX2__)
+	if (!avx2_supported())
+	{
+		return skipped;
+	}
+#endif
+
+	int failures = 0;
+
+	// Known answers from the reference C implementations (splitmix64.c, xoshiro256starstar.c and
+	// pcg_basic.c).
+	{
+		std::uint64_t state = 0;
+		failures += check(splitmix64(state) == 0xe220a8397b1dcdaf && splitmix64(state) == 0x6e789e6aa1b965f4, "splitmix64 matches the reference");
+
+		c_xoshiro256 rand(0x5eed);
+		failures += check(rand.state() == c_xoshiro256::state_t{ 0x09f1fd9d03f0a9b4, 0x553274161bbf8475, 0x5d5bca4696b343b3, 0x70d29b6c7d22528d }, "xoshiro256** is seeded with splitmix64");
+		c_xoshiro256 jumped = rand;
+		jumped.jump();
+		c_xoshiro256 long_jumped = rand;
+		long_jumped.long_jump();
+		failures += check(rand.next_u64() == 0xef33f17055244b74 && rand.next_u64() == 0xe1f591112fb5051b && rand.next_u64() == 0xd8ab05640214863a && rand.next_u64() == 0xf985e1f2fb897b03, "xoshiro256** matches the reference");
+		failures += check(jumped.next_u64() == 0xe7b2da517a568753 && jumped.next_u64() == 0x7e0106c087a6b67f && jumped.next_u64() == 0x15d89fbaee5c564e && jumped.next_u64() == 0xa53d7493f1aec506, "xoshiro256** jump matches the reference");
+		failures += check(long_jumped.next_u64() == 0xa9bb704022a1d3a4 && long_jumped.next_u64() == 0x732ba1cf9bc1f6f1 && long_jumped.next_u64() == 0x7ac99614c57ab96e && long_jumped.next_u64() == 0x937f3b0a58fe4b40, "xoshiro256** long jump matches the reference");
+
+		c_pcg32 pcg(42, 54);
+		std::uint32_t const expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+		bool same = true;
+		for (std::uint32_t value : expected)
+		{
+			same = pcg.next_u32() == value && same;
+		}
+		failures += check(same, "pcg32 matches the reference");
+	}
+
+	// split() hands back the current sequence and moves the engine a long jump ahead.
+	{
+		c_xoshiro256 rand(7);
+		c_xoshiro256 long_jumped(7);
+		long_jumped.long_jump();
+		c_xoshiro256 const stream = rand.split();
+		failures += check(same_sequence(stream, c_xoshiro256(7)) && same_sequence(rand, long_jumped), "xoshiro256** split");
+
+		c_xoshiro256x4 rand4(7);
+		c_xoshiro256x4 long_jumped4(7);
+		long_jumped4.long_jump();
+		c_xoshiro256x4 const stream4 = rand4.split();
+		failures += check(same_sequence(stream4, c_xoshiro256x4(7)) && same_sequence(rand4, long_jumped4), "xoshiro256x4 split");
+
+		c_pcg32 advanced(99, 3);
+		c_pcg32 stepped(99, 3);
+		advanced.advance(1000);
+		for (std::uint32_t i = 0; i < 1000; ++i)
+		{
+			stepped.next_u32();
+		}
+		failures += check(same_sequence(advanced, stepped), "pcg32 advance matches stepping");
+		failures += check(!same_sequence(c_pcg32(99, 3), c_pcg32(99, 4), 1), "pcg32 streams differ");
+	}
+
+	// The x4 engine's lanes are the base engine jumped 0-3 times, read out in lane order.
+	{
+		c_xoshiro256x4 rand4(0x5eed);
+		std::array<c_xoshiro256, c_xoshiro256x4::lanes> lanes = reference_lanes(0x5eed);
+		bool same = true;
+		for (std::uint32_t step = 0; step < 8; ++step)
+		{
+			for (c_xoshiro256& lane : lanes)
+			{
+				same = rand4.next_u64() == lane.next_u64() && same;
+			}
+		}
+		failures += check(same, "xoshiro256x4 lanes match jumped xoshiro256** engines");
+	}
+
+	// Bulk fills match a scalar fill. Sizes cover whole blocks and tails, the ranges include heavy
+	// rejection, and the engines must continue with the same values afterwards.
+	for (std::size_t count : { std::size_t{ 1 }, std::size_t{ 7 }, std::size_t{ 8 }, std::size_t{ 61 }, std::size_t{ 1000 } })
+	{
+		struct s_range
+		{
+			std::uint32_t min;
+			std::uint32_t max;
+		};
+		for (s_range range : { s_range{ 0, 0xffffffff }, s_range{ 10, 15 }, s_range{ 0, 0x80000000 }, s_range{ 3, 3 } })
+		{
+			c_xoshiro256x4 rand4(count);
+			std::array<c_xoshiro256, c_xoshiro256x4::lanes> lanes = reference_lanes(count);
+			std::vector<std::uint32_t> out(count);
+			rand4.fill(std::span<std::uint32_t>(out), range.min, range.max);
+			failures += check(out == reference_fill(lanes, count, range.min, range.max), "uint32 fill matches a scalar fill");
+			failures += check(rand4.next_u64() == lanes[0].next_u64(), "uint32 fill leaves the same state");
+		}
+
+		c_xoshiro256x4 rand4(count);
+		std::array<c_xoshiro256, c_xoshiro256x4::lanes> lanes = reference_lanes(count);
+		std::vector<std::int32_t> ints(count);
+		rand4.fill(std::span<std::int32_t>(ints), -5, 5);
+		std::vector<std::uint32_t> const expected = reference_fill(lanes, count, static_cast<std::uint32_t>(-5), 5u);
+		bool same = true;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			same = ints[i] == static_cast<std::int32_t>(expected[i]) && same;
+		}
+		failures += check(same, "int32 fill matches a scalar fill");
+
+		c_xoshiro256x4 rand_float4(count);
+		lanes = reference_lanes(count);
+		std::vector<float> floats(count);
+		rand_float4.fill(std::span<float>(floats), -2.0f, 3.5f);
+		failures += check(floats == reference_fill(lanes, count, -2.0f, 3.5f), "float fill matches a scalar fill");
+		failures += check(rand_float4.next_u64() == lanes[0].next_u64(), "float fill leaves the same state");
+	}
+
+	// Regression: with a one-ulp range, min + unit * (max - min) rounds up to max for half of all
+	// draws, which rand_float and the float fill must clamp away.
+	{
+		float const min = 1.0f;
+		float const max = std::nextafter(min, 2.0f);
+		c_pcg32 pcg(1);
+		c_xoshiro256 xoshiro(1);
+		bool below = true;
+		for (std::uint32_t i = 0; i < 1000; ++i)
+		{
+			below = pcg.rand_float(min, max) < max && xoshiro.rand_float(min, max) < max && below;
+			below = xoshiro.rand_float(1.0, std::nextafter(1.0, 2.0)) < std::nextafter(1.0, 2.0) && below;
+		}
+		failures += check(below, "rand_float stays below max");
+
+		c_xoshiro256x4 rand4(1);
+		std::vector<float> out(1003);
+		rand4.fill(std::span<float>(out), min, max);
+		bool fill_below = true;
+		for (float value : out)
+		{
+			fill_below = value == min && fill_below;
+		}
+		failures += check(fill_below, "float fill stays below max");
+		failures += check(pcg.rand_float(2.0f, 2.0f) == 2.0f, "rand_float with min == max returns min");
+	}
+
+	return failures == 0 ? 0 : 1;
+}
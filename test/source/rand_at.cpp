@@ -0,0 +1,88 @@
+#include "core/math.h"
+#include "core/rand.h"
+#include "test.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+// Values recorded when rand_at started using both halves of each Philox block. Saved worlds and
+// replays depend on them, so any change here is a format change.
+static_assert(det_rand_int<std::int32_t>(0, 100) == 88 && det_rand_int<std::int32_t>(1, 100) == 60 && det_rand_int<std::int32_t>(2, 100) == 36);
+static_assert(det_rand_int<std::int32_t>(12345, 7) == 4 && det_rand_int<std::int32_t>(-1, 100) == 37 && det_rand_int<std::int32_t>(-77, 7) == 1);
+static_assert(det_rand_int<std::uint64_t>(0) == 0xe169c58d6627e8d4 && det_rand_int<std::uint64_t>(3, 1000) == 37 && det_rand_int<std::uint64_t>(0xffffffffffffffff, 1000) == 199);
+static_assert(det_rand_int<std::int32_t>(5, 0) == 0 && det_rand_int<std::int32_t>(5, -3) == 0 && det_rand_int<std::int32_t>(5, 1) == 0);
+
+int main()
+{
+#if defined(__AVX2__)
+	if (!avx2_supported())
+	{
+		return skipped;
+	}
+#endif
+
+	int failures = 0;
+
+	// More known answers from the Random123 distribution (kat_vectors).
+	failures += check(philox4x32({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }) == std::array<std::uint32_t, 4>{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }, "philox4x32 all-ones vector");
+	failures += check(philox4x32({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }) == std::array<std::uint32_t, 4>{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }, "philox4x32 pi vector");
+
+	// Run time matches compile time, and counters 2i and 2i + 1 share block i.
+	std::uint64_t const key = 0x5eed;
+	failures += check(rand_at(key, 0) == 0x6f56ed39ee1c2fcc && rand_at(key, 1) == 0x14c3f3d7e29a6034, "rand_at block 0");
+	failures += check(rand_at(key, 2) == 0xa8c6f7ebe79e8ee4 && rand_at(key, 3) == 0x64bcb6e3fecdd894, "rand_at block 1");
+	failures += check(rand_at(key, 0xffffffffffffffff) == 0x09436c939bd0bbbc, "rand_at last counter");
+
+	// The batch form matches single calls for odd and even starts, every tail length and runs
+	// that wrap past the last counter.
+	c_xoshiro256 rand(27);
+	bool same = true;
+	std::vector<std::uint64_t> out;
+	for (std::uint32_t round = 0; round < 400; ++round)
+	{
+		std::uint64_t const batch_key = rand.next_u64();
+		std::uint64_t first = rand.next_u64();
+		if (round % 4 == 0)
+		{
+			first = 0 - rand.rand_int<std::uint64_t>(0, 40);
+		}
+		else if (round % 4 == 1)
+		{
+			first = rand.rand_int<std::uint64_t>(0, 40);
+		}
+		out.assign(rand.rand_int<std::size_t>(0, 37), 0);
+		rand_at(batch_key, first, out);
+		for (std::size_t i = 0; i < out.size(); ++i)
+		{
+			same = same && out[i] == rand_at(batch_key, first + i);
+		}
+	}
+	failures += check(same, "batch rand_at matches single calls");
+
+	// det_rand_int stays in [0, max) and draws from rand_at(0, seed), with negative seeds read as
+	// their unsigned 32-bit pattern.
+	bool in_range = true;
+	bool matches = true;
+	std::vector<std::uint64_t> negative(500);
+	std::vector<std::uint64_t> positive(500);
+	rand_at(0, static_cast<std::uint32_t>(-500), negative);
+	rand_at(0, 0, positive);
+	for (std::int32_t max : { 1, 2, 3, 7, 100, 1 << 20, 0x7fffffff })
+	{
+		for (std::int32_t seed = -500; seed < 500; ++seed)
+		{
+			std::int32_t const value = det_rand_int(seed, max);
+			std::uint64_t const bits = seed < 0 ? negative[static_cast<std::size_t>(seed + 500)] : positive[static_cast<std::size_t>(seed)];
+			in_range = in_range && value >= 0 && value < max;
+			matches = matches && value == static_cast<std::int32_t>(mul_hi(bits, static_cast<std::uint64_t>(max)));
+		}
+	}
+	failures += check(in_range, "det_rand_int stays below max");
+	failures += check(matches, "det_rand_int matches the batch rand_at");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#include "core/sprite_batch.h"
+#include "test.h"
+
+#include <vector>
+
+using namespace tt;
+using namespace tt::test;
+
+// Texture ids are 16 bits of the sort key, so a batch refuses a sprite that needs one texture too
+// many instead of drawing it with a texture whose id it shares.
+int main()
+{
+	int failures = 0;
+	std::vector<sf::Texture> textures(c_sprite_batch::max_textures + 1);
+	c_sprite_batch batch;
+
+	s_sprite sprite;
+	sprite.rect = { 0, 0, 1, 1 };
+	bool added = true;
+	for (std::uint32_t i = 0; i < c_sprite_batch::max_textures; ++i)
+	{
+		sprite.texture = &textures[i];
+		added = batch.add(sprite) && added;
+	}
+	failures += check(added, "max_textures distinct textures fit");
+
+	sprite.texture = &textures[c_sprite_batch::max_textures];
+	failures += check(!batch.add(sprite), "one texture past the limit is rejected");
+	sprite.texture = &textures[0];
+	failures += check(batch.add(sprite), "textures already in the batch are still accepted");
+
+	batch.build();
+	failures += check(batch.vertices().getVertexCount() == (c_sprite_batch::max_textures + 1) * 4, "rejected sprite is not drawn");
+	bool textures_match = batch.runs().size() == c_sprite_batch::max_textures;
+	for (c_sprite_batch::s_run const& run : batch.runs())
+	{
+		textures_match = textures_match && run.texture != &textures[c_sprite_batch::max_textures];
+	}
+	failures += check(textures_match, "every run uses a texture from the batch");
+	failures += check(batch.runs()[0].texture == &textures[0] && batch.runs()[0].vertex_count == 8, "sprites sharing a texture share a run");
+
+	batch.clear();
+	sprite.texture = &textures[c_sprite_batch::max_textures];
+	failures += check(batch.add(sprite), "clear() makes room for new textures");
+
+	return failures == 0 ? 0 : 1;
+}
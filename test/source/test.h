@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Helpers shared by the test programs. Each test is its own executable and returns non-zero when a
+// check fails.
+namespace tt::test
+{
+	// Exit code ctest reports as a skipped test (SKIP_RETURN_CODE in test/CMakeLists.txt).
+	constexpr int skipped = 77;
+
+	// Tests built against the AVX2 kernels skip themselves on CPUs without AVX2.
+	inline bool avx2_supported()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	// Prints what failed and returns 1, so results can be summed.
+	inline int check(bool condition, char const* what)
+	{
+		if (!condition)
+		{
+			std::printf("failed: %s\n", what);
+			return 1;
+		}
+		return 0;
+	}
+
+	inline sf::Event key(sf::Event::EventType type, sf::Keyboard::Key code)
+	{
+		sf::Event event;
+		event.type = type;
+		event.key = {};
+		event.key.code = code;
+		return event;
+	}
+
+	inline sf::Event button(sf::Event::EventType type, sf::Mouse::Button code)
+	{
+		sf::Event event;
+		event.type = type;
+		event.mouseButton = {};
+		event.mouseButton.button = code;
+		return event;
+	}
+
+	inline sf::Event move(std::int32_t x, std::int32_t y)
+	{
+		sf::Event event;
+		event.type = sf::Event::MouseMoved;
+		event.mouseMove = { x, y };
+		return event;
+	}
+}